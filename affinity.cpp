@@ -0,0 +1,258 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "affinity.hpp"
+#include "perf_counters.hpp"
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+static std::vector<int> decoder_cpus;
+static std::vector<int> worker_cpus;
+
+/// Used to spread the worker threads across the worker CPUs.
+static std::atomic<size_t> next_worker_cpu(0);
+
+
+/// The counters of one thread.
+struct ThreadInfo
+{
+	std::string		name;
+	pid_t			tid;
+	std::unique_ptr<PerfCounter> migrations;
+	std::unique_ptr<PerfCounter> context_switches;
+	bool			finished			= false;
+	int				last_cpu			= -1;
+	uint64_t		final_migrations	= 0;
+	uint64_t		final_switches		= 0;
+};
+
+
+/// Every registered thread, including the ones which have exited.  Deliberately never destroyed.
+struct ThreadRegistry
+{
+	std::mutex mutex;
+	std::list<ThreadInfo> threads;
+};
+
+
+static ThreadRegistry & thread_registry()
+{
+	static ThreadRegistry * registry = new ThreadRegistry;
+	return *registry;
+}
+
+
+/// Saves the final counts when the thread exits.
+struct ThreadRegistration
+{
+	ThreadInfo * info = nullptr;
+
+	~ThreadRegistration()
+	{
+		if (info)
+		{
+			ThreadRegistry & registry = thread_registry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			info->final_migrations	= info->migrations->read();
+			info->final_switches	= info->context_switches->read();
+			info->last_cpu			= sched_getcpu();
+			info->finished			= true;
+			info->migrations		.reset();
+			info->context_switches	.reset();
+		}
+	}
+};
+
+static thread_local ThreadRegistration thread_registration;
+
+
+std::vector<int> parse_cpu_list(const std::string & text)
+{
+	if (text == "isolated")
+	{
+		return get_isolated_cpus();
+	}
+
+	std::vector<int> cpus;
+	std::stringstream ss(text);
+	std::string range;
+	while (std::getline(ss, range, ','))
+	{
+		if (range.empty() or range == "\n")
+		{
+			continue;
+		}
+		const size_t dash = range.find('-');
+		const int first	= std::stoi(range.substr(0, dash));
+		const int last	= (dash == std::string::npos ? first : std::stoi(range.substr(dash + 1)));
+		for (int cpu = first; cpu <= last; cpu ++)
+		{
+			cpus.push_back(cpu);
+		}
+	}
+
+	return cpus;
+}
+
+
+std::vector<int> get_isolated_cpus()
+{
+	std::ifstream ifs("/sys/devices/system/cpu/isolated");
+	std::string line;
+	std::getline(ifs, line);
+
+	return line.empty() ? std::vector<int>() : parse_cpu_list(line);
+}
+
+
+void set_stage_cpus(const PipelineStage stage, const std::vector<int> & cpus)
+{
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	sched_getaffinity(0, sizeof(allowed), &allowed);
+
+	std::vector<int> & stage_cpus = (stage == PipelineStage::decoder ? decoder_cpus : worker_cpus);
+	stage_cpus.clear();
+	for (const int cpu : cpus)
+	{
+		if (cpu >= 0 and cpu < CPU_SETSIZE and CPU_ISSET(cpu, &allowed))
+		{
+			stage_cpus.push_back(cpu);
+		}
+		else
+		{
+			std::cout << "-> ignoring CPU " << cpu << " since it is not in this process' cpuset" << std::endl;
+		}
+	}
+
+	return;
+}
+
+
+const std::vector<int> & get_stage_cpus(const PipelineStage stage)
+{
+	return (stage == PipelineStage::decoder ? decoder_cpus : worker_cpus);
+}
+
+
+bool pin_thread_to_stage(const PipelineStage stage, const int index)
+{
+	const std::vector<int> & cpus = get_stage_cpus(stage);
+	if (cpus.empty())
+	{
+		return false;
+	}
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (stage == PipelineStage::workers)
+	{
+		const size_t n = (index >= 0 ? index : next_worker_cpu ++);
+		CPU_SET(cpus[n % cpus.size()], &set);
+	}
+	else
+	{
+		for (const int cpu : cpus)
+		{
+			CPU_SET(cpu, &set);
+		}
+	}
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+
+void register_thread(const std::string & name)
+{
+	if (thread_registration.info)
+	{
+		// already registered; just rename it
+		std::lock_guard<std::mutex> lock(thread_registry().mutex);
+		thread_registration.info->name = name;
+		return;
+	}
+
+	ThreadRegistry & registry = thread_registry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.threads.emplace_back();
+	ThreadInfo & info = registry.threads.back();
+	info.name				= name;
+	info.tid				= syscall(SYS_gettid);
+	info.migrations			.reset(new PerfCounter(PerfCounter::Event::cpu_migrations	, 0, false));
+	info.context_switches	.reset(new PerfCounter(PerfCounter::Event::context_switches	, 0, false));
+	thread_registration.info = &info;
+
+	return;
+}
+
+
+/// The CPU a thread last ran on is the 39th field of its stat file.
+static int get_thread_cpu(const pid_t tid)
+{
+	std::ifstream ifs("/proc/self/task/" + std::to_string(tid) + "/stat");
+	std::string line;
+	std::getline(ifs, line);
+
+	// skip the command name since it may contain spaces, then the state is field 3
+	const size_t pos = line.rfind(')');
+	if (pos == std::string::npos)
+	{
+		return -1;
+	}
+	std::stringstream ss(line.substr(pos + 2));
+	std::string field;
+	for (int idx = 3; idx <= 39; idx ++)
+	{
+		if (not (ss >> field))
+		{
+			return -1;
+		}
+	}
+
+	return std::stoi(field);
+}
+
+
+void show_thread_stats()
+{
+	ThreadRegistry & registry = thread_registry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	uint64_t total_migrations = 0;
+	for (auto & info : registry.threads)
+	{
+		const uint64_t migrations	= (info.finished ? info.final_migrations	: info.migrations		->read());
+		const uint64_t switches		= (info.finished ? info.final_switches		: info.context_switches	->read());
+		const int cpu				= (info.finished ? info.last_cpu			: get_thread_cpu(info.tid));
+		total_migrations += migrations;
+
+		std::cout
+			<< "-> thread " << info.tid << " (" << info.name << "): "
+			<< migrations << " CPU migrations, "
+			<< switches << " context switches, "
+			<< (info.finished ? "exited on CPU " : "on CPU ") << cpu
+			<< std::endl;
+	}
+
+	if (registry.threads.empty() == false and registry.threads.front().migrations and registry.threads.front().migrations->is_valid() == false)
+	{
+		std::cout << "-> migration counters are not available (check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+	}
+	else
+	{
+		std::cout << "-> " << total_migrations << " CPU migrations across " << registry.threads.size() << " threads" << std::endl;
+	}
+
+	return;
+}
@@ -0,0 +1,52 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+/** The kinds of threads in the pipeline.  The decoder is whichever thread reads the frames:  the main thread, the batch
+ * file threads, or the shard coordinator.  It also displays or exports the results.  The workers are the threads of
+ * the worker pools, and the shard worker processes.
+ */
+enum class PipelineStage
+{
+	decoder,
+	workers
+};
+
+
+/// Parse a kernel CPU list such as @p "0-15,32-47".  The word @p "isolated" means the CPUs given to @p isolcpus=.
+std::vector<int> parse_cpu_list(const std::string & text);
+
+
+/// CPUs which were removed from the scheduler with the @p isolcpus= kernel parameter, from @p /sys/devices/system/cpu/isolated.
+std::vector<int> get_isolated_cpus();
+
+
+/** Set the CPUs a stage may run on.  An empty list (the default) leaves the stage alone.  CPUs which are not in this
+ * process' cpuset are ignored.  Must be called before the threads are started.
+ */
+void set_stage_cpus(const PipelineStage stage, const std::vector<int> & cpus);
+
+const std::vector<int> & get_stage_cpus(const PipelineStage stage);
+
+
+/** Pin the calling thread according to its stage.  Each worker thread is pinned to a single CPU since the scheduler
+ * doesn't balance threads across isolated CPUs.  The CPU is the @p index'th one in the stage's list, or the next one
+ * round-robin if @p index is negative.  Returns @p false if no CPUs were configured for this stage or if the kernel
+ * refused.
+ */
+bool pin_thread_to_stage(const PipelineStage stage, const int index = -1);
+
+
+/** Start counting the CPU migrations and context switches of the calling thread so they can be shown by
+ * @ref show_thread_stats().  The counts are kept after the thread exits.
+ */
+void register_thread(const std::string & name);
+
+
+/// Show the CPU, migrations and context switches of every thread which called @ref register_thread().
+void show_thread_stats();
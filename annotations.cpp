@@ -0,0 +1,525 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "annotations.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+
+AnnotationFormat to_annotation_format(const std::string & name)
+{
+	if (name == "auto")	return AnnotationFormat::automatic;
+	if (name == "csv")	return AnnotationFormat::csv;
+	if (name == "json")	return AnnotationFormat::json;
+	if (name == "mot")	return AnnotationFormat::mot;
+
+	throw std::invalid_argument("annotation format must be auto, csv, json, or mot (not \"" + name + "\")");
+}
+
+
+AnnotationUnits to_annotation_units(const std::string & name)
+{
+	if (name == "auto")			return AnnotationUnits::automatic;
+	if (name == "pixels")		return AnnotationUnits::pixels;
+	if (name == "normalized")	return AnnotationUnits::normalized;
+
+	throw std::invalid_argument("annotation units must be auto, pixels, or normalized (not \"" + name + "\")");
+}
+
+
+static std::string_view trim(std::string_view text)
+{
+	while (text.empty() == false and std::isspace(static_cast<unsigned char>(text.front())))
+	{
+		text.remove_prefix(1);
+	}
+	while (text.empty() == false and std::isspace(static_cast<unsigned char>(text.back())))
+	{
+		text.remove_suffix(1);
+	}
+
+	return text;
+}
+
+
+/// Much faster than std::stod() since it doesn't need a std::string, doesn't use the locale, and doesn't throw.
+static bool parse_number(std::string_view text, double & value)
+{
+	text = trim(text);
+	if (text.empty() == false and text.front() == '+')
+	{
+		text.remove_prefix(1);
+	}
+	const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+
+	return result.ec == std::errc() and result.ptr == text.data() + text.size();
+}
+
+
+/// Match the many names used for the same column.  Returns an empty string for columns we don't use.
+static std::string to_field_name(std::string_view name)
+{
+	std::string lower(trim(name));
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+	if (lower.size() >= 2 and lower.front() == '"' and lower.back() == '"')
+	{
+		lower = lower.substr(1, lower.size() - 2);
+	}
+
+	if (lower == "frame"	or lower == "start_frame"	or lower == "frame_index")				return "frame";
+	if (lower == "name"		or lower == "id"			or lower == "object"	or lower == "label")	return "name";
+	if (lower == "x"		or lower == "left"			or lower == "bb_left")					return "x";
+	if (lower == "y"		or lower == "top"			or lower == "bb_top")					return "y";
+	if (lower == "w"		or lower == "width"			or lower == "bb_width")					return "w";
+	if (lower == "h"		or lower == "height"		or lower == "bb_height")				return "h";
+	if (lower == "conf"		or lower == "confidence")											return "conf";
+	if (lower == "bbox"		or lower == "box"			or lower == "rect")						return "bbox";
+
+	return "";
+}
+
+
+AnnotationReader::AnnotationReader(const std::string & fn, const AnnotationFormat f, const AnnotationUnits u) :
+	filename(fn),
+	format(f),
+	units(u),
+	buffer(1024 * 1024),
+	line_number(0),
+	seed_count(0),
+	has_next(false),
+	columns_known(false),
+	column_frame(-1),
+	column_name(-1),
+	column_x(-1),
+	column_y(-1),
+	column_w(-1),
+	column_h(-1),
+	column_conf(-1)
+{
+	if (format == AnnotationFormat::automatic)
+	{
+		const auto pos = filename.rfind('.');
+		std::string extension = (pos == std::string::npos ? "" : filename.substr(pos + 1));
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+		format =	extension == "json"	or extension == "jsonl"	? AnnotationFormat::json	:
+					extension == "txt"							? AnnotationFormat::mot		:
+																  AnnotationFormat::csv;
+	}
+
+	if (format == AnnotationFormat::mot)
+	{
+		// MOTChallenge files have no header, and always use pixels
+		columns_known	= true;
+		column_frame	= 0;
+		column_name		= 1;
+		column_x		= 2;
+		column_y		= 3;
+		column_w		= 4;
+		column_h		= 5;
+		column_conf		= 6;
+		units			= AnnotationUnits::pixels;
+	}
+
+	// the buffer must be set before the file is opened
+	ifs.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+	ifs.open(filename);
+	if (ifs.good() == false)
+	{
+		throw std::invalid_argument("failed to open annotation file " + filename);
+	}
+
+	return;
+}
+
+
+size_t AnnotationReader::get_seeds(const size_t frame_index, VAnnotationSeeds & seeds)
+{
+	size_t count = 0;
+	while (true)
+	{
+		if (has_next == false)
+		{
+			has_next = read_seed(next);
+			if (has_next == false)
+			{
+				break;
+			}
+		}
+
+		if (next.frame_index > frame_index)
+		{
+			// keep it for later
+			break;
+		}
+
+		seeds.push_back(std::move(next));
+		has_next = false;
+		count ++;
+	}
+
+	seed_count += count;
+
+	return count;
+}
+
+
+bool AnnotationReader::read_seed(AnnotationSeed & seed)
+{
+	if (format == AnnotationFormat::json)
+	{
+		return read_json(seed);
+	}
+
+	return read_csv(seed);
+}
+
+
+bool AnnotationReader::read_csv(AnnotationSeed & seed)
+{
+	std::string line;
+	std::vector<std::string_view> fields;
+	while (std::getline(ifs, line))
+	{
+		line_number ++;
+
+		const std::string_view text = trim(line);
+		if (text.empty() or text.front() == '#')
+		{
+			continue;
+		}
+
+		fields.clear();
+		size_t start = 0;
+		while (true)
+		{
+			const size_t comma = text.find(',', start);
+			fields.push_back(text.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start));
+			if (comma == std::string_view::npos)
+			{
+				break;
+			}
+			start = comma + 1;
+		}
+
+		if (columns_known == false)
+		{
+			columns_known = true;
+
+			double ignored = 0.0;
+			if (fields.size() >= 2 and parse_number(fields[1], ignored) == false)
+			{
+				// this is a header, so use it to find the columns
+				for (int idx = 0; idx < static_cast<int>(fields.size()); idx ++)
+				{
+					const std::string name = to_field_name(fields[idx]);
+					if (name == "frame")	column_frame	= idx;
+					if (name == "name")		column_name		= idx;
+					if (name == "x")		column_x		= idx;
+					if (name == "y")		column_y		= idx;
+					if (name == "w")		column_w		= idx;
+					if (name == "h")		column_h		= idx;
+					if (name == "conf")		column_conf		= idx;
+				}
+				if (column_name < 0 or column_x < 0 or column_y < 0 or column_w < 0 or column_h < 0)
+				{
+					fail("the header must name the name, x, y, w and h columns");
+				}
+				continue;
+			}
+
+			// no header:  name, x, y, w, h, and an optional start frame
+			column_name		= 0;
+			column_x		= 1;
+			column_y		= 2;
+			column_w		= 3;
+			column_h		= 4;
+			column_frame	= 5;
+		}
+
+		const int needed = std::max({column_name, column_x, column_y, column_w, column_h});
+		if (static_cast<int>(fields.size()) <= needed)
+		{
+			fail("expected at least " + std::to_string(needed + 1) + " columns");
+		}
+
+		double frame = 0.0;
+		if (column_frame >= 0 and column_frame < static_cast<int>(fields.size()) and parse_number(fields[column_frame], frame) == false)
+		{
+			fail("invalid frame number");
+		}
+		if (format == AnnotationFormat::mot)
+		{
+			frame -= 1.0;
+		}
+
+		double conf = 1.0;
+		if (column_conf >= 0 and column_conf < static_cast<int>(fields.size()) and parse_number(fields[column_conf], conf) and conf == 0.0)
+		{
+			// MOT ground truth uses a zero here to mark boxes which must be ignored
+			continue;
+		}
+
+		if (parse_number(fields[column_x], seed.rect.x		) == false or
+			parse_number(fields[column_y], seed.rect.y		) == false or
+			parse_number(fields[column_w], seed.rect.width	) == false or
+			parse_number(fields[column_h], seed.rect.height	) == false)
+		{
+			fail("invalid coordinates");
+		}
+
+		seed.frame_index	= static_cast<size_t>(std::max(0.0, frame));
+		std::string_view name = trim(fields[column_name]);
+		if (name.size() >= 2 and name.front() == '"' and name.back() == '"')
+		{
+			name = name.substr(1, name.size() - 2);
+		}
+		seed.name			= std::string(name);
+		set_units(seed);
+
+		return true;
+	}
+
+	return false;
+}
+
+
+bool AnnotationReader::read_json(AnnotationSeed & seed)
+{
+	std::streambuf & in = *ifs.rdbuf();
+
+	// get the next character which isn't whitespace, counting lines as we go
+	auto next_char = [&]() -> int
+	{
+		while (true)
+		{
+			const int c = in.sbumpc();
+			if (c == '\n')
+			{
+				line_number ++;
+			}
+			if (c == std::char_traits<char>::eof() or std::isspace(c) == 0)
+			{
+				return c;
+			}
+		}
+	};
+
+	auto read_string = [&]() -> std::string
+	{
+		std::string str;
+		while (true)
+		{
+			int c = in.sbumpc();
+			if (c == std::char_traits<char>::eof())
+			{
+				fail("unterminated string");
+			}
+			if (c == '"')
+			{
+				return str;
+			}
+			if (c == '\\')
+			{
+				c = in.sbumpc();
+			}
+			str += static_cast<char>(c);
+		}
+	};
+
+	auto read_number = [&](int c) -> double
+	{
+		std::string str(1, static_cast<char>(c));
+		while (true)
+		{
+			c = in.sgetc();
+			if (c == std::char_traits<char>::eof() or std::strchr("+-.0123456789eE", c) == nullptr)
+			{
+				break;
+			}
+			str += static_cast<char>(in.sbumpc());
+		}
+		double value = 0.0;
+		if (parse_number(str, value) == false)
+		{
+			fail("invalid number \"" + str + "\"");
+		}
+		return value;
+	};
+
+	// find the start of the next object; the array brackets and commas between the objects are skipped
+	int c = 0;
+	while (true)
+	{
+		c = next_char();
+		if (c == std::char_traits<char>::eof())
+		{
+			return false;
+		}
+		if (c == '{')
+		{
+			break;
+		}
+		if (c != '[' and c != ']' and c != ',')
+		{
+			fail("expected an object");
+		}
+	}
+
+	double frame = 0.0;
+	bool has_name = false;
+	std::vector<double> box(4, 0.0);
+	std::vector<bool> has_box(4, false);
+
+	while (true)
+	{
+		c = next_char();
+		if (c == '}')
+		{
+			break;
+		}
+		if (c == ',')
+		{
+			continue;
+		}
+		if (c != '"')
+		{
+			fail("expected a key");
+		}
+		const std::string key = to_field_name(read_string());
+		if (next_char() != ':')
+		{
+			fail("expected ':' after the key");
+		}
+
+		c = next_char();
+		if (c == '"')
+		{
+			const std::string value = read_string();
+			if (key == "name")
+			{
+				seed.name	= value;
+				has_name	= true;
+			}
+		}
+		else if (c == '[')
+		{
+			// only arrays of numbers are supported, such as "bbox": [x, y, w, h]
+			std::vector<double> values;
+			while (true)
+			{
+				c = next_char();
+				if (c == ']')
+				{
+					break;
+				}
+				if (c == ',')
+				{
+					continue;
+				}
+				values.push_back(read_number(c));
+			}
+			if (key == "bbox")
+			{
+				if (values.size() != 4)
+				{
+					fail("expected 4 values in the box");
+				}
+				box = values;
+				has_box.assign(4, true);
+			}
+		}
+		else if (c == 't' or c == 'f' or c == 'n')
+		{
+			// true, false, or null
+			while (std::isalpha(in.sgetc()))
+			{
+				in.sbumpc();
+			}
+		}
+		else if (c == '{')
+		{
+			fail("nested objects are not supported");
+		}
+		else
+		{
+			const double value = read_number(c);
+			if		(key == "frame"	)	frame = value;
+			else if	(key == "name"	)	{ seed.name = std::to_string(static_cast<long long>(value)); has_name = true; }
+			else if	(key == "x"		)	{ box[0] = value; has_box[0] = true; }
+			else if	(key == "y"		)	{ box[1] = value; has_box[1] = true; }
+			else if	(key == "w"		)	{ box[2] = value; has_box[2] = true; }
+			else if	(key == "h"		)	{ box[3] = value; has_box[3] = true; }
+		}
+	}
+
+	if (has_name == false or std::find(has_box.begin(), has_box.end(), false) != has_box.end())
+	{
+		fail("each object needs a name and x, y, w, h (or a bbox)");
+	}
+
+	seed.frame_index	= static_cast<size_t>(std::max(0.0, frame));
+	seed.rect			= cv::Rect2d(box[0], box[1], box[2], box[3]);
+	set_units(seed);
+
+	return true;
+}
+
+
+void AnnotationReader::set_units(AnnotationSeed & seed) const
+{
+	const cv::Rect2d & r = seed.rect;
+	seed.normalized =	units == AnnotationUnits::normalized or
+						(units == AnnotationUnits::automatic and
+						r.x >= 0.0 and r.y >= 0.0 and r.width <= 1.0 and r.height <= 1.0 and r.x + r.width <= 1.0 and r.y + r.height <= 1.0);
+
+	return;
+}
+
+
+void AnnotationReader::fail(const std::string & msg) const
+{
+	throw std::runtime_error(filename + " line #" + std::to_string(line_number) + ": " + msg);
+}
+
+
+cv::Rect2d scale_seed(const AnnotationSeed & seed, const TrackingSession & session)
+{
+	cv::Rect2d r = seed.rect;
+	if (seed.normalized)
+	{
+		r = cv::Rect2d(r.x * session.video_size.width, r.y * session.video_size.height, r.width * session.video_size.width, r.height * session.video_size.height);
+	}
+	r = session.video_to_frame(r);
+
+	// boxes which are partly outside the frame (or the ROI) are clipped; boxes which are completely outside are ignored
+	r &= cv::Rect2d(0.0, 0.0, session.desired_size.width, session.desired_size.height);
+	if (r.width < 1.0 or r.height < 1.0)
+	{
+		return cv::Rect2d();
+	}
+
+	return r;
+}
+
+
+void apply_seeds(TrackingSession & session, const VAnnotationSeeds & seeds, cv::Mat & mat)
+{
+	const cv::Scalar colours[] = {red, blue, green, purple};
+
+	for (const auto & seed : seeds)
+	{
+		const cv::Rect2d r = scale_seed(seed, session);
+		if (r.empty())
+		{
+			continue;
+		}
+
+		const cv::Scalar & colour = colours[std::hash<std::string>()(seed.name) % 4];
+		session.add_tracker(seed.name, colour, r, mat);
+	}
+
+	return;
+}
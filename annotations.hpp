@@ -0,0 +1,113 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "tracking_session.hpp"
+#include <fstream>
+
+
+/// Layouts of annotation files which can be used to seed the trackers.
+enum class AnnotationFormat
+{
+	automatic,	///< from the file extension:  @p .json is JSON, @p .txt is MOT, anything else is CSV
+	csv,		///< @p name,x,y,w,h[,start_frame] or any order of columns given by a header line
+	json,		///< an array of (or one per line) objects such as @p {"frame":0,"name":"ball","bbox":[x,y,w,h]}
+	mot			///< MOTChallenge @p frame,id,left,top,width,height,conf,... with 1-based frames and pixel coordinates
+};
+
+AnnotationFormat to_annotation_format(const std::string & name);
+
+
+/// How the coordinates in an annotation file are given.
+enum class AnnotationUnits
+{
+	automatic,	///< each box whose X, Y, W and H are all between 0 and 1 is normalized, others are pixels
+	pixels,		///< pixels of the original video, before it is resized
+	normalized	///< fractions of the frame width and height
+};
+
+AnnotationUnits to_annotation_units(const std::string & name);
+
+
+/// One object to start tracking (or to re-seed, if it is already being tracked) at a given frame.
+struct AnnotationSeed
+{
+	size_t		frame_index;	///< zero-based
+	std::string	name;
+	cv::Rect2d	rect;
+	bool		normalized;		///< @p true if @ref rect is in fractions of the frame, @p false if in pixels of the original video
+};
+
+typedef std::vector<AnnotationSeed> VAnnotationSeeds;
+
+
+/** Reads seed boxes from an annotation file a few at a time as the video plays, so files with millions of rows are
+ * never loaded in one go.  The file must be sorted by frame; a seed which appears after a later frame was already
+ * requested is returned on the next call.
+ */
+class AnnotationReader
+{
+	public:
+
+		AnnotationReader(const std::string & filename, const AnnotationFormat format = AnnotationFormat::automatic, const AnnotationUnits units = AnnotationUnits::automatic);
+
+		/** Append to @p seeds every seed for frames up to and including @p frame_index which hasn't already been
+		 * returned.  Returns the number of seeds appended.
+		 */
+		size_t get_seeds(const size_t frame_index, VAnnotationSeeds & seeds);
+
+		/// Total number of seeds returned so far.
+		size_t get_seed_count() const { return seed_count; }
+
+		const std::string filename;
+
+	private:
+
+		/// Read the next seed from the file.  Returns @p false at the end of the file.
+		bool read_seed(AnnotationSeed & seed);
+
+		bool read_csv(AnnotationSeed & seed);
+		bool read_json(AnnotationSeed & seed);
+
+		/// Set @ref AnnotationSeed::normalized according to @ref units.
+		void set_units(AnnotationSeed & seed) const;
+
+		/// Throws a std::runtime_error which mentions the file and the line.
+		[[noreturn]] void fail(const std::string & msg) const;
+
+		AnnotationFormat format;
+		AnnotationUnits units;
+		std::ifstream ifs;
+		std::vector<char> buffer;	///< large read buffer for @ref ifs
+		size_t line_number;
+		size_t seed_count;
+
+		/// The seed which was read but belongs to a later frame. @{
+		bool has_next;
+		AnnotationSeed next;
+		/// @}
+
+		/// Column of each field in a CSV file; @p -1 if the column is missing. @{
+		bool columns_known;
+		int column_frame;
+		int column_name;
+		int column_x;
+		int column_y;
+		int column_w;
+		int column_h;
+		int column_conf;
+		/// @}
+};
+
+
+/** Convert the coordinates of @p seed to pixels of the frames @p session tracks, which may be cropped and resized.  The
+ * box is clipped to the frame; an empty rectangle is returned if nothing is left.
+ */
+cv::Rect2d scale_seed(const AnnotationSeed & seed, const TrackingSession & session);
+
+
+/** Add (or replace) a tracker for each seed, initialized on @p mat.  Coordinates are scaled from the original video's
+ * resolution or from normalized values to the frames the session tracks.
+ */
+void apply_seeds(TrackingSession & session, const VAnnotationSeeds & seeds, cv::Mat & mat);
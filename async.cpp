@@ -0,0 +1,186 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "async.hpp"
+
+
+/// A coroutine which starts immediately and cleans up after itself; used to run the tasks given to @ref EventLoop::spawn().
+struct EventLoop::DetachedTask
+{
+	struct promise_type
+	{
+		DetachedTask get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() { return; }
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+
+EventLoop::EventLoop() :
+	running_tasks(0)
+{
+	return;
+}
+
+
+EventLoop::DetachedTask EventLoop::run_detached(EventLoop & loop, Task<void> task)
+{
+	std::exception_ptr e;
+	try
+	{
+		co_await task;
+	}
+	catch (...)
+	{
+		e = std::current_exception();
+	}
+
+	loop.task_finished(e);
+
+	co_return;
+}
+
+
+void EventLoop::spawn(Task<void> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running_tasks ++;
+	}
+
+	// the task runs on the calling thread until it first suspends
+	run_detached(*this, std::move(task));
+
+	return;
+}
+
+
+void EventLoop::post(std::coroutine_handle<> handle, const std::chrono::high_resolution_clock::time_point when)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	ready.emplace(when, handle);
+	trigger.notify_one();
+
+	return;
+}
+
+
+void EventLoop::task_finished(std::exception_ptr e)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (e and not error)
+	{
+		error = e;
+	}
+	running_tasks --;
+	trigger.notify_one();
+
+	return;
+}
+
+
+void EventLoop::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (running_tasks > 0)
+	{
+		if (ready.empty())
+		{
+			trigger.wait(lock);
+			continue;
+		}
+
+		const auto when = ready.begin()->first;
+		if (when > std::chrono::high_resolution_clock::now())
+		{
+			// nothing is due yet, but something may be posted which must run sooner
+			trigger.wait_until(lock, when);
+			continue;
+		}
+
+		auto handle = ready.begin()->second;
+		ready.erase(ready.begin());
+
+		lock.unlock();
+		handle.resume();
+		lock.lock();
+	}
+
+	if (error)
+	{
+		std::exception_ptr e = error;
+		error = nullptr;
+		std::rethrow_exception(e);
+	}
+
+	return;
+}
+
+
+AsyncSemaphore::AsyncSemaphore(const size_t count) :
+	available(count),
+	closed(false)
+{
+	return;
+}
+
+
+bool AsyncSemaphore::wait(std::coroutine_handle<> handle)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (closed or available > 0)
+	{
+		if (not closed)
+		{
+			available --;
+		}
+		return false;
+	}
+
+	waiting.push_back(handle);
+
+	return true;
+}
+
+
+void AsyncSemaphore::release()
+{
+	std::coroutine_handle<> handle;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (waiting.empty())
+		{
+			available ++;
+			return;
+		}
+
+		// the slot goes straight to the oldest waiting coroutine
+		handle = waiting.front();
+		waiting.pop_front();
+	}
+
+	handle.resume();
+
+	return;
+}
+
+
+void AsyncSemaphore::close()
+{
+	std::deque<std::coroutine_handle<>> handles;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		handles.swap(waiting);
+	}
+
+	for (auto handle : handles)
+	{
+		handle.resume();
+	}
+
+	return;
+}
@@ -0,0 +1,227 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "worker_pool.hpp"
+#include <coroutine>
+#include <exception>
+#include <map>
+#include <optional>
+
+
+/* A few small C++20 coroutine building blocks so the stages of the frame loop (decoding, tracking, drawing and
+ * display) can be written as straight-line code while each one runs on the thread which suits it.  A coroutine moves
+ * to another thread by awaiting @ref resume_on() or @ref EventLoop::sleep_until(), and suspends without blocking a
+ * thread while it waits for tracking results or for a free frame slot.
+ */
+
+
+/// The parts of a task's promise which don't depend on the type of result.
+struct TaskPromiseBase
+{
+	/// Resumes whoever awaited the task once it has finished.
+	struct FinalAwaiter
+	{
+		bool await_ready() noexcept { return false; }
+
+		template <typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept { return handle.promise().continuation; }
+
+		void await_resume() noexcept { return; }
+	};
+
+	std::suspend_always initial_suspend() noexcept { return {}; }
+	FinalAwaiter final_suspend() noexcept { return {}; }
+	void unhandled_exception() { error = std::current_exception(); }
+
+	std::coroutine_handle<> continuation = std::noop_coroutine();
+	std::exception_ptr error;
+};
+
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase
+{
+	void return_value(T v) { value = std::move(v); }
+
+	T result()
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+		return std::move(*value);
+	}
+
+	std::optional<T> value;
+};
+
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase
+{
+	void return_void() { return; }
+
+	void result()
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+		return;
+	}
+};
+
+
+/** A coroutine which returns a @p T.  It doesn't start until it is awaited, and the awaiting coroutine is resumed on
+ * whichever thread the task finishes on.  Exceptions are re-thrown to the awaiting coroutine.
+ */
+template <typename T = void>
+class [[nodiscard]] Task
+{
+	public:
+
+		struct promise_type : TaskPromise<T>
+		{
+			Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		};
+
+		Task(Task && rhs) noexcept : handle(rhs.handle) { rhs.handle = nullptr; }
+
+		~Task()
+		{
+			if (handle)
+			{
+				handle.destroy();
+			}
+		}
+
+		Task(const Task &) = delete;
+		Task & operator=(const Task &) = delete;
+
+		bool await_ready() const noexcept { return false; }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+		{
+			handle.promise().continuation = awaiting;
+			return handle;
+		}
+
+		T await_resume() { return handle.promise().result(); }
+
+	private:
+
+		explicit Task(std::coroutine_handle<promise_type> h) : handle(h) { return; }
+
+		std::coroutine_handle<promise_type> handle;
+};
+
+
+/// Continue the calling coroutine on one of the threads of @p pool.
+inline auto resume_on(WorkerPool & pool)
+{
+	struct Awaiter
+	{
+		WorkerPool & pool;
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) { pool.submit([handle] { handle.resume(); }); }
+		void await_resume() noexcept { return; }
+	};
+
+	return Awaiter{pool};
+}
+
+
+/** Runs coroutines on the thread which calls @ref run(), normally the main thread since that is the only one which
+ * may use the OpenCV windows.  Any thread may hand a coroutine to the loop.
+ */
+class EventLoop
+{
+	public:
+
+		EventLoop();
+
+		/// Start @p task on the loop.  It runs until it finishes; @ref run() returns once every spawned task has finished.
+		void spawn(Task<void> task);
+
+		/// Run the coroutines until every spawned task has finished, then re-throw the first exception any of them threw.
+		void run();
+
+		/// Continue the calling coroutine on the loop's thread once @p when has been reached.
+		auto sleep_until(const std::chrono::high_resolution_clock::time_point when)
+		{
+			struct Awaiter
+			{
+				EventLoop & loop;
+				std::chrono::high_resolution_clock::time_point when;
+
+				bool await_ready() const noexcept { return false; }
+				void await_suspend(std::coroutine_handle<> handle) { loop.post(handle, when); }
+				void await_resume() noexcept { return; }
+			};
+
+			return Awaiter{*this, when};
+		}
+
+		/// Continue the calling coroutine on the loop's thread.
+		auto schedule() { return sleep_until(std::chrono::high_resolution_clock::time_point()); }
+
+	private:
+
+		void post(std::coroutine_handle<> handle, const std::chrono::high_resolution_clock::time_point when);
+
+		void task_finished(std::exception_ptr e);
+
+		struct DetachedTask;
+		static DetachedTask run_detached(EventLoop & loop, Task<void> task);
+
+		std::mutex mutex;
+		std::condition_variable trigger;
+		std::multimap<std::chrono::high_resolution_clock::time_point, std::coroutine_handle<>> ready;	///< ordered by the time they may resume
+		size_t running_tasks;
+		std::exception_ptr error;
+};
+
+
+/** Counts free slots, such as the number of frames which may be in flight.  A coroutine which awaits @ref acquire()
+ * while no slot is free is suspended until another one calls @ref release().
+ */
+class AsyncSemaphore
+{
+	public:
+
+		explicit AsyncSemaphore(const size_t count);
+
+		/// Returns @p true once a slot has been taken, or @p false if the semaphore was closed.
+		auto acquire()
+		{
+			struct Awaiter
+			{
+				AsyncSemaphore & semaphore;
+
+				bool await_ready() const noexcept { return false; }
+				bool await_suspend(std::coroutine_handle<> handle) { return semaphore.wait(handle); }
+				bool await_resume() noexcept { return semaphore.closed == false; }
+			};
+
+			return Awaiter{*this};
+		}
+
+		/// Give back a slot, resuming one waiting coroutine on the calling thread.
+		void release();
+
+		/// Wake up every waiting coroutine.  From now on @ref acquire() returns @p false immediately.
+		void close();
+
+	private:
+
+		/// Take a slot or queue @p handle.  Returns @p false if the coroutine doesn't need to be suspended.
+		bool wait(std::coroutine_handle<> handle);
+
+		std::mutex mutex;
+		size_t available;
+		std::atomic<bool> closed;
+		std::deque<std::coroutine_handle<>> waiting;
+};
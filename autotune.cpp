@@ -0,0 +1,411 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "autotune.hpp"
+#include "stats.hpp"
+#include <iterator>
+
+
+/// One frame of the cached clip, with the ground truth of every object which is visible in it.
+struct ClipFrame
+{
+	cv::Mat								mat;
+	std::map<std::string, cv::Rect2d>	truth;
+};
+
+
+/// Objects are grouped by the square root of the area of their first box, in pixels of the tracking size.
+struct SizeClass
+{
+	std::string	name;
+	double		max_side;
+};
+
+static const SizeClass size_classes[] =
+{
+	{"small"	, 48.0								},
+	{"medium"	, 112.0								},
+	{"large"	, std::numeric_limits<double>::max()}
+};
+
+static const size_t number_of_size_classes = std::size(size_classes);
+
+
+/// A continuous stretch of frames where one object has ground truth.  The tracker is created on the first frame.
+struct Sequence
+{
+	std::string	name;
+	size_t		first_frame;
+	size_t		last_frame;		///< inclusive
+	size_t		size_class;		///< index into @ref size_classes
+};
+
+
+/// How well one candidate did on the objects of one size class.
+struct ClassScore
+{
+	LatencySamples	latencies;	///< time of each call to @p update(), in milliseconds
+	double			iou_sum		= 0.0;
+	size_t			failures	= 0;
+
+	double mean_iou() const { return latencies.empty() ? 0.0 : iou_sum / latencies.size(); }
+};
+
+
+static double intersection_over_union(const cv::Rect2d & lhs, const cv::Rect2d & rhs)
+{
+	const double intersection	= (lhs & rhs).area();
+	const double total			= lhs.area() + rhs.area() - intersection;
+
+	return (total > 0.0 ? intersection / total : 0.0);
+}
+
+
+/// Pick random values for the parameters which make the biggest difference to speed and accuracy.
+static cv::TrackerCSRT::Params random_params(cv::RNG & rng)
+{
+	auto pick = [&](const auto & values)
+	{
+		return values[rng.uniform(0, static_cast<int>(std::size(values)))];
+	};
+
+	const float	paddings[]			= {1.5f, 2.0f, 2.5f, 3.0f, 3.5f};
+	const float	template_sizes[]	= {64.0f, 100.0f, 150.0f, 200.0f, 250.0f};
+	const int	scales[]			= {9, 17, 25, 33};
+	const float	filter_lrs[]		= {0.01f, 0.02f, 0.04f, 0.08f};
+	const int	admm_iterations[]	= {1, 2, 3, 4};
+	const bool	toggles[]			= {false, true};
+
+	cv::TrackerCSRT::Params params;
+	params.padding				= pick(paddings);
+	params.template_size		= pick(template_sizes);
+	params.number_of_scales		= pick(scales);
+	params.filter_lr			= pick(filter_lrs);
+	params.admm_iterations		= pick(admm_iterations);
+	params.use_hog				= pick(toggles);
+	params.use_color_names		= pick(toggles);
+	params.use_gray				= pick(toggles);
+	params.use_rgb				= pick(toggles);
+	params.use_segmentation		= pick(toggles);
+	params.use_channel_weights	= pick(toggles);
+
+	if (not (params.use_hog or params.use_color_names or params.use_gray or params.use_rgb))
+	{
+		// CSRT needs at least one kind of feature
+		params.use_hog = true;
+	}
+
+	return params;
+}
+
+
+static std::string describe(const cv::TrackerCSRT::Params & params)
+{
+	std::stringstream ss;
+	ss	<< "padding="		<< params.padding
+		<< " template="		<< params.template_size
+		<< " scales="		<< params.number_of_scales
+		<< " lr="			<< params.filter_lr
+		<< " admm="			<< params.admm_iterations
+		<< " features="		<< (params.use_hog ? "H" : "") << (params.use_color_names ? "C" : "") << (params.use_gray ? "G" : "") << (params.use_rgb ? "R" : "")
+		<< (params.use_segmentation		? " segmentation"		: "")
+		<< (params.use_channel_weights	? " channel_weights"	: "");
+
+	return ss.str();
+}
+
+
+/// Decode the clip once and attach the ground truth to each frame.
+static std::vector<ClipFrame> load_clip(TrackingSession & session, const VAnnotationSeeds & truth, const size_t number_of_frames)
+{
+	std::vector<ClipFrame> clip;
+	while (clip.size() < number_of_frames)
+	{
+		ClipFrame frame;
+		if (session.read_frame(frame.mat) == false)
+		{
+			break;
+		}
+
+		if (truth.empty() and session.cap.is_synthetic())
+		{
+			for (const auto & obj : session.cap.ground_truth())
+			{
+				if (obj.visible)
+				{
+					frame.truth["obj" + std::to_string(obj.id)] = session.video_to_frame(obj.rect);
+				}
+			}
+		}
+
+		clip.push_back(frame);
+	}
+
+	for (const auto & seed : truth)
+	{
+		if (seed.frame_index < clip.size())
+		{
+			const cv::Rect2d r = scale_seed(seed, session);
+			if (r.empty() == false)
+			{
+				clip[seed.frame_index].truth[seed.name] = r;
+			}
+		}
+	}
+
+	return clip;
+}
+
+
+/// Split the ground truth into sequences of consecutive frames for each object.
+static std::vector<Sequence> find_sequences(const std::vector<ClipFrame> & clip)
+{
+	std::vector<Sequence> sequences;
+	std::map<std::string, size_t> open_sequences;	///< object name to index in @p sequences
+
+	for (size_t frame_index = 0; frame_index < clip.size(); frame_index ++)
+	{
+		// objects which disappeared end their sequence
+		for (auto iter = open_sequences.begin(); iter != open_sequences.end(); )
+		{
+			if (clip[frame_index].truth.count(iter->first) == 0)
+			{
+				iter = open_sequences.erase(iter);
+			}
+			else
+			{
+				sequences[iter->second].last_frame = frame_index;
+				iter ++;
+			}
+		}
+
+		for (const auto & [name, rect] : clip[frame_index].truth)
+		{
+			if (open_sequences.count(name) or rect.width < 4.0 or rect.height < 4.0)
+			{
+				continue;
+			}
+
+			Sequence sequence;
+			sequence.name			= name;
+			sequence.first_frame	= frame_index;
+			sequence.last_frame		= frame_index;
+			sequence.size_class		= 0;
+			while (std::sqrt(rect.area()) >= size_classes[sequence.size_class].max_side)
+			{
+				sequence.size_class ++;
+			}
+			open_sequences[name] = sequences.size();
+			sequences.push_back(sequence);
+		}
+	}
+
+	// a tracker needs at least one update to be measured
+	sequences.erase(std::remove_if(sequences.begin(), sequences.end(), [](const Sequence & sequence) { return sequence.last_frame == sequence.first_frame; }), sequences.end());
+
+	return sequences;
+}
+
+
+/// Track every sequence with one set of parameters.
+static std::vector<ClassScore> evaluate(const std::vector<ClipFrame> & clip, const std::vector<Sequence> & sequences, const TrackerProfile & profile)
+{
+	std::vector<ClassScore> scores(number_of_size_classes);
+
+	for (const auto & sequence : sequences)
+	{
+		ClassScore & score = scores[sequence.size_class];
+
+		Tracker tracker = create_tracker(profile);
+		tracker->init(clip[sequence.first_frame].mat, clip[sequence.first_frame].truth.at(sequence.name));
+
+		for (size_t frame_index = sequence.first_frame + 1; frame_index <= sequence.last_frame; frame_index ++)
+		{
+			cv::Rect2d rect;
+			const auto start_time = std::chrono::high_resolution_clock::now();
+			const bool found = tracker->update(clip[frame_index].mat, rect);
+			score.latencies.add(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count());
+
+			if (found)
+			{
+				score.iou_sum += intersection_over_union(rect, clip[frame_index].truth.at(sequence.name));
+			}
+			else
+			{
+				score.failures ++;
+			}
+		}
+	}
+
+	return scores;
+}
+
+
+/// Only names which are valid YAML keys can be written to the @p objects section.
+static bool is_valid_key(const std::string & name)
+{
+	if (name.empty() or std::isalpha(static_cast<unsigned char>(name[0])) == 0)
+	{
+		return false;
+	}
+
+	return std::all_of(name.begin(), name.end(), [](const char c) { return std::isalnum(static_cast<unsigned char>(c)) or c == '_' or c == '-'; });
+}
+
+
+bool run_autotune(TrackingSession & session, const VAnnotationSeeds & truth, const AutotuneOptions & options)
+{
+	if (truth.empty() and session.cap.is_synthetic() == false)
+	{
+		throw std::invalid_argument("auto-tuning needs ground truth:  use --annotations or the synthetic input");
+	}
+	if (options.candidates == 0 or options.frames < 2 or not (options.budget_milliseconds > 0.0))
+	{
+		throw std::invalid_argument("auto-tuning needs at least 1 candidate, 2 frames, and a positive time budget");
+	}
+
+	const std::vector<ClipFrame> clip = load_clip(session, truth, options.frames);
+	const std::vector<Sequence> sequences = find_sequences(clip);
+	if (sequences.empty())
+	{
+		throw std::runtime_error("no objects have ground truth in the first " + std::to_string(clip.size()) + " frames of " + session.name);
+	}
+
+	std::vector<size_t> sequences_per_class(number_of_size_classes, 0);
+	for (const auto & sequence : sequences)
+	{
+		sequences_per_class[sequence.size_class] ++;
+	}
+
+	std::cout << "-> auto-tuning " << options.candidates << " candidates on " << clip.size() << " frames with " << sequences.size() << " object sequences (";
+	for (size_t idx = 0; idx < number_of_size_classes; idx ++)
+	{
+		std::cout << (idx ? ", " : "") << sequences_per_class[idx] << " " << size_classes[idx].name;
+	}
+	std::cout << "), budget " << options.budget_milliseconds << " ms per update" << std::endl;
+
+	struct Candidate
+	{
+		TrackerProfile			profile;
+		std::vector<ClassScore>	scores;
+	};
+	std::vector<Candidate> candidates;
+
+	cv::RNG rng(options.seed);
+	for (size_t idx = 0; idx < options.candidates; idx ++)
+	{
+		Candidate candidate;
+		candidate.profile.tracker_type = "csrt";
+		if (idx > 0)
+		{
+			// the first candidate is always OpenCV's defaults so there is something to compare against
+			candidate.profile.csrt_params = random_params(rng);
+		}
+		candidate.scores = evaluate(clip, sequences, candidate.profile);
+
+		std::cout << "-> candidate " << (idx + 1) << "/" << options.candidates << ": " << describe(candidate.profile.csrt_params) << std::endl << "  ";
+		for (size_t class_index = 0; class_index < number_of_size_classes; class_index ++)
+		{
+			const ClassScore & score = candidate.scores[class_index];
+			if (score.latencies.empty() == false)
+			{
+				std::cout
+					<< " " << size_classes[class_index].name << ": IoU=" << std::fixed << std::setprecision(3) << score.mean_iou()
+					<< " mean=" << std::setprecision(2) << score.latencies.mean() << " ms"
+					<< " p99=" << score.latencies.quantile(0.99) << " ms"
+					<< std::defaultfloat;
+			}
+		}
+		std::cout << std::endl;
+
+		candidates.push_back(candidate);
+	}
+
+	cv::FileStorage fs(options.output_filename, cv::FileStorage::WRITE);
+	if (fs.isOpened() == false)
+	{
+		throw std::runtime_error("failed to create " + options.output_filename);
+	}
+	fs.writeComment("CSRT profiles found by --autotune on " + session.name + " with a budget of " + std::to_string(options.budget_milliseconds) + " ms per update");
+	fs << "profiles" << "{";
+
+	bool all_within_budget = true;
+	std::cout << "-> best candidate per size class:" << std::endl;
+	for (size_t class_index = 0; class_index < number_of_size_classes; class_index ++)
+	{
+		if (sequences_per_class[class_index] == 0)
+		{
+			continue;
+		}
+
+		auto score_of = [&](const Candidate & candidate) -> const ClassScore & { return candidate.scores[class_index]; };
+
+		// the most accurate candidate which fits within the budget, or the fastest one if none of them fit
+		const Candidate * best = nullptr;
+		for (const auto & candidate : candidates)
+		{
+			if (score_of(candidate).latencies.mean() <= options.budget_milliseconds and (best == nullptr or score_of(candidate).mean_iou() > score_of(*best).mean_iou()))
+			{
+				best = &candidate;
+			}
+		}
+		const bool within_budget = (best != nullptr);
+		if (within_budget == false)
+		{
+			all_within_budget = false;
+			best = &*std::min_element(candidates.begin(), candidates.end(), [&](const Candidate & lhs, const Candidate & rhs) { return score_of(lhs).latencies.mean() < score_of(rhs).latencies.mean(); });
+		}
+
+		const ClassScore & score	= score_of(*best);
+		const ClassScore & baseline	= score_of(candidates.front());
+		const cv::TrackerCSRT::Params & params = best->profile.csrt_params;
+		std::cout
+			<< "   " << std::left << std::setw(7) << size_classes[class_index].name << std::right
+			<< std::fixed << std::setprecision(3)
+			<< " IoU=" << score.mean_iou() << " (defaults " << baseline.mean_iou() << ")"
+			<< std::setprecision(2)
+			<< " mean=" << score.latencies.mean() << " ms (defaults " << baseline.latencies.mean() << " ms)"
+			<< " failures=" << score.failures
+			<< std::defaultfloat
+			<< (within_budget ? "" : " -- NOTHING FITS THE BUDGET, USING THE FASTEST")
+			<< std::endl
+			<< "           " << describe(params) << std::endl;
+
+		fs.writeComment(size_classes[class_index].name + ": mean IoU " + std::to_string(score.mean_iou()) + ", mean update " + std::to_string(score.latencies.mean()) + " ms" + (within_budget ? "" : " (over budget)"));
+		fs << size_classes[class_index].name << "{"
+			<< "tracker" << "csrt"
+			<< "csrt" << "{"
+				<< "padding"				<< params.padding
+				<< "template_size"			<< params.template_size
+				<< "number_of_scales"		<< params.number_of_scales
+				<< "filter_lr"				<< params.filter_lr
+				<< "admm_iterations"		<< params.admm_iterations
+				<< "use_hog"				<< static_cast<int>(params.use_hog)
+				<< "use_color_names"		<< static_cast<int>(params.use_color_names)
+				<< "use_gray"				<< static_cast<int>(params.use_gray)
+				<< "use_rgb"				<< static_cast<int>(params.use_rgb)
+				<< "use_segmentation"		<< static_cast<int>(params.use_segmentation)
+				<< "use_channel_weights"	<< static_cast<int>(params.use_channel_weights)
+			<< "}"
+			<< "}";
+	}
+	fs << "}";
+
+	// each object seen in the clip uses the profile for the size it had when it first appeared
+	fs << "objects" << "{";
+	std::set<std::string> names;
+	for (const auto & sequence : sequences)
+	{
+		if (is_valid_key(sequence.name) and names.insert(sequence.name).second)
+		{
+			fs << sequence.name << size_classes[sequence.size_class].name;
+		}
+	}
+	fs << "}";
+	fs.release();
+
+	std::cout << "-> profiles written to " << options.output_filename << std::endl;
+
+	return all_within_budget;
+}
@@ -0,0 +1,33 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "annotations.hpp"
+
+
+/// Settings which control an auto-tuning run.  See @ref run_autotune().
+struct AutotuneOptions
+{
+	double		budget_milliseconds	= 10.0;				///< the mean time of one tracker update must not exceed this
+	size_t		candidates			= 40;				///< number of parameter sets to try, including the defaults
+	size_t		frames				= 150;				///< length of the clip which is cached and tracked for each candidate
+	uint64_t	seed				= 1;				///< makes the search repeatable
+	std::string	output_filename		= "autotune.yaml";	///< profiles which can be given to @p --config
+};
+
+
+/** Search the CSRT parameter space for the most accurate settings which fit within a per-update time budget.  The
+ * first @p AutotuneOptions::frames frames of @p session are decoded once and kept in memory.  Each object is tracked
+ * from the first frame where it has ground truth until the ground truth ends, once per candidate set of parameters,
+ * and the accuracy is the mean intersection-over-union with the ground truth (a frame where the tracker reports a
+ * failure counts as zero).  Objects are grouped by size since small objects need very different settings than large
+ * ones, and the best candidate for each size class is written as a profile which can be loaded with @p --config.
+ *
+ * The ground truth is @p truth (in the same coordinates as annotation seeds) or, if that is empty, the exact positions
+ * from the synthetic generator.  The update times are measured on the calling thread, so this should be run on an
+ * otherwise idle machine with the same thread budget as the deployment.
+ *
+ * @returns @p false if no candidate fits within the budget for at least one of the size classes.
+ */
+bool run_autotune(TrackingSession & session, const VAnnotationSeeds & truth, const AutotuneOptions & options);
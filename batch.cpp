@@ -0,0 +1,442 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "batch.hpp"
+#include "affinity.hpp"
+#include "numa.hpp"
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+
+/// What happened to one file.  See @ref process_file().
+struct BatchFileResult
+{
+	std::string	filename;
+	std::string	output_filename;
+	size_t		frames		= 0;		///< frames in the video, including the ones which were skipped
+	size_t		tracked		= 0;		///< frames which were decoded and tracked
+	size_t		trackers	= 0;
+	size_t		duplicates	= 0;		///< frames which repeated the previous one and weren't tracked
+	double		seconds		= 0.0;
+	std::string	error;			///< empty if the file was processed successfully
+};
+
+
+VBatchItems load_batch(const std::string & path)
+{
+	VBatchItems items;
+
+	if (std::filesystem::is_directory(path))
+	{
+		const std::set<std::string> extensions = {".avi", ".m4v", ".mkv", ".mov", ".mp4", ".mpeg", ".mpg", ".webm"};
+		for (const auto & entry : std::filesystem::directory_iterator(path))
+		{
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+			if (entry.is_regular_file() and extensions.count(extension))
+			{
+				items.push_back({entry.path().string(), {}});
+			}
+		}
+
+		// directory order is random, so sort the files to make the output repeatable
+		std::sort(items.begin(), items.end(), [](const BatchItem & lhs, const BatchItem & rhs) { return lhs.filename < rhs.filename; });
+
+		return items;
+	}
+
+	std::ifstream ifs(path);
+	if (ifs.good() == false)
+	{
+		throw std::invalid_argument("failed to open batch manifest " + path);
+	}
+
+	std::string line;
+	while (std::getline(ifs, line))
+	{
+		std::istringstream iss(line);
+		BatchItem item;
+		if (not (iss >> item.filename) or item.filename[0] == '#')
+		{
+			continue;
+		}
+
+		BatchBox box;
+		while (iss >> box.name)
+		{
+			if (not (iss >> box.rect.x >> box.rect.y >> box.rect.width >> box.rect.height))
+			{
+				throw std::invalid_argument("expected the name followed by X, Y, W, H for each box in this line of " + path + ": " + line);
+			}
+			item.boxes.push_back(box);
+		}
+		items.push_back(item);
+	}
+
+	return items;
+}
+
+
+/// Write one line of a file's CSV results.  @p rect is in the coordinates of the original video.
+static void write_row(std::ofstream & csv, const size_t frame_index, const std::string & name, const bool found, const cv::Rect2d & rect, const bool interpolated)
+{
+	csv << frame_index << "," << name << "," << (found ? 1 : 0);
+	if (found)
+	{
+		csv	<< std::fixed << std::setprecision(1)
+			<< "," << rect.x
+			<< "," << rect.y
+			<< "," << rect.width
+			<< "," << rect.height;
+	}
+	else
+	{
+		csv << ",,,,";
+	}
+	csv << "," << (interpolated ? 1 : 0) << "\n";
+
+	return;
+}
+
+
+/// Track the objects in one video and write the results.  This runs on one of the file threads.
+static BatchFileResult process_file(WorkerPool & pool, const BatchItem & item, const std::string & output_filename, const BatchOptions & options, TrackerInitializer initialize)
+{
+	BatchFileResult result;
+	result.filename			= item.filename;
+	result.output_filename	= output_filename;
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+
+	try
+	{
+		TrackingSession session(pool);
+		session.open(item.filename, TrackingSession::default_maximum_size, false);
+
+		// only every Nth frame is tracked; the others are grabbed but never retrieved, so they skip the colour conversion
+		size_t decimation = std::max<size_t>(1, options.decimation);
+		if (options.analysis_fps > 0.0)
+		{
+			decimation = std::max<size_t>(1, std::round(session.fps_rounded / options.analysis_fps));
+		}
+		if (decimation > 1)
+		{
+			// trackers time out after a number of tracked frames, so keep the timeout the same length in seconds
+			session.fps_rounded = std::max<size_t>(1, std::round(static_cast<double>(session.fps_rounded) / decimation));
+		}
+
+		cv::Mat mat = session.get_first_frame();
+		if (item.boxes.empty())
+		{
+			initialize(session, mat);
+		}
+		for (const auto & box : item.boxes)
+		{
+			session.add_tracker(box.name, green, box.rect.x, box.rect.y, box.rect.width, box.rect.height, mat);
+		}
+		result.trackers = session.get_tracks().size();
+
+		std::ofstream csv(output_filename);
+		if (csv.good() == false)
+		{
+			throw std::runtime_error("failed to create " + output_filename);
+		}
+		csv << "frame,name,found,x,y,width,height,interpolated" << std::endl;
+
+		// index within the video of each frame which has been pushed but not yet pulled
+		std::deque<size_t> source_indices;
+		size_t next_source_index = 0;
+
+		// the most recent tracked frame, used to interpolate the frames which were skipped after it
+		std::map<std::string, cv::Rect2d> previous_rects;
+		std::vector<std::string> previous_names;	///< every object which was still valid, found or not
+		size_t previous_index = 0;
+
+		// keep a few frames queued so decoding the next frames overlaps with tracking the current one
+		const size_t frames_in_flight = 2;
+		bool more_frames_to_read = true;
+		while (true)
+		{
+			while (more_frames_to_read and session.frames_in_flight() < frames_in_flight)
+			{
+				for (size_t skipped = 1; next_source_index > 0 and skipped < decimation and more_frames_to_read; skipped ++)
+				{
+					more_frames_to_read = session.skip_frame();
+					if (more_frames_to_read)
+					{
+						next_source_index ++;
+					}
+				}
+				if (more_frames_to_read == false)
+				{
+					break;
+				}
+
+				cv::Mat frame;
+				more_frames_to_read = session.read_frame(frame);
+				if (more_frames_to_read)
+				{
+					session.push_frame(frame);
+					source_indices.push_back(next_source_index ++);
+				}
+			}
+
+			FrameResults results;
+			if (session.pull_results(results) == false)
+			{
+				break;
+			}
+			const size_t source_index = source_indices.front();
+			source_indices.pop_front();
+
+			// the results are written in the coordinates of the original video, not the cropped and resized frames
+			std::map<std::string, cv::Rect2d> rects;
+			std::vector<std::string> names;
+			for (const auto & track : results.tracks)
+			{
+				if (track.valid)
+				{
+					names.push_back(track.name);
+				}
+				if (track.valid and track.found)
+				{
+					rects[track.name] = session.frame_to_video(track.rect);
+				}
+			}
+
+			// the skipped frames get boxes which move linearly from the previous tracked frame to this one, but only
+			// when the object was found in both; objects which were valid then (even if retired since) are not found
+			for (size_t idx = previous_index + 1; result.tracked > 0 and idx < source_index; idx ++)
+			{
+				const double t = static_cast<double>(idx - previous_index) / (source_index - previous_index);
+				for (const auto & name : previous_names)
+				{
+					const auto previous	= previous_rects.find(name);
+					const auto current	= rects.find(name);
+					cv::Rect2d r;
+					const bool found = (previous != previous_rects.end() and current != rects.end());
+					if (found)
+					{
+						const cv::Rect2d & p = previous->second;
+						const cv::Rect2d & c = current->second;
+						r = cv::Rect2d(
+							p.x			+ t * (c.x		- p.x		),
+							p.y			+ t * (c.y		- p.y		),
+							p.width		+ t * (c.width	- p.width	),
+							p.height	+ t * (c.height	- p.height	));
+					}
+					write_row(csv, idx, name, found, r, true);
+				}
+			}
+
+			for (const auto & track : results.tracks)
+			{
+				if (track.valid)
+				{
+					write_row(csv, source_index, track.name, track.found, track.found ? rects[track.name] : cv::Rect2d(), false);
+				}
+			}
+
+			previous_rects.swap(rects);
+			previous_names.swap(names);
+			previous_index = source_index;
+			result.tracked ++;
+		}
+
+		// frames skipped after the last tracked frame have nothing to interpolate towards, so they keep the last boxes
+		for (size_t idx = previous_index + 1; result.tracked > 0 and idx < next_source_index; idx ++)
+		{
+			for (const auto & name : previous_names)
+			{
+				const auto previous = previous_rects.find(name);
+				const bool found = (previous != previous_rects.end());
+				write_row(csv, idx, name, found, found ? previous->second : cv::Rect2d(), true);
+			}
+		}
+		result.frames = next_source_index;
+		result.duplicates = session.duplicate_frames();
+	}
+	catch (const std::exception & e)
+	{
+		result.error = e.what();
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+	return result;
+}
+
+
+bool run_batch(const VBatchItems & items, const BatchOptions & options, TrackerInitializer initialize)
+{
+	if (items.empty())
+	{
+		throw std::invalid_argument("no videos to process");
+	}
+
+	std::filesystem::create_directories(options.output_directory);
+
+	// each file gets its own output filename, even if several videos in different directories have the same name
+	std::vector<std::string> output_filenames;
+	std::set<std::string> used_names;
+	for (size_t idx = 0; idx < items.size(); idx ++)
+	{
+		std::string name = std::filesystem::path(items[idx].filename).stem().string();
+		if (name.empty() or used_names.count(name))
+		{
+			name += "_" + std::to_string(idx);
+		}
+		used_names.insert(name);
+		output_filenames.push_back((std::filesystem::path(options.output_directory) / (name + ".csv")).string());
+	}
+
+	// split the core budget between the file threads (decoding and exporting), the worker pool (tracking), and OpenCV
+	const size_t cores				= make_thread_budget(options.cores, options.thread_policy).cores;
+	const size_t concurrent_files	= std::min(items.size(), (options.concurrent_files > 0 ? options.concurrent_files : std::max<size_t>(1, cores / 4)));
+	const ThreadBudget budget		= make_thread_budget(cores, options.thread_policy, concurrent_files);
+	const size_t worker_threads		= budget.worker_threads;
+	apply_thread_budget(budget);
+	show_thread_budget(budget);
+
+	std::cout
+		<< "-> batch processing " << items.size() << " files, " << concurrent_files << " at a time, "
+		<< "with " << worker_threads << " tracking threads"
+		<< std::endl;
+
+	// with NUMA enabled each node gets its own pool, and each file thread stays on one node
+	const VNumaNodes & nodes = get_numa_nodes();
+	std::vector<std::unique_ptr<WorkerPool>> pools;
+	if (options.numa)
+	{
+		size_t total_cpus = 0;
+		for (const auto & node : nodes)
+		{
+			total_cpus += node.cpus.size();
+		}
+		for (size_t idx = 0; idx < nodes.size(); idx ++)
+		{
+			pools.emplace_back(new WorkerPool(std::max<size_t>(1, worker_threads * nodes[idx].cpus.size() / total_cpus), idx));
+		}
+	}
+	else
+	{
+		pools.emplace_back(new WorkerPool(worker_threads));
+	}
+
+	std::vector<BatchFileResult> results(items.size());
+	std::atomic<size_t> next_item(0);
+	std::mutex output_mutex;
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::thread> threads;
+	for (size_t idx = 0; idx < concurrent_files; idx ++)
+	{
+		threads.emplace_back([&, idx]
+			{
+				const size_t node = idx % pools.size();
+				if (pin_thread_to_stage(PipelineStage::decoder))
+				{
+					// explicit decoder CPUs take precedence over the NUMA node
+				}
+				else if (options.numa)
+				{
+					// decoded frames are then allocated on the same node as the workers which track them
+					pin_thread_to_numa_node(node);
+				}
+				register_thread("file " + std::to_string(idx));
+
+				while (true)
+				{
+					const size_t item_index = next_item ++;
+					if (item_index >= items.size())
+					{
+						break;
+					}
+
+					results[item_index] = process_file(*pools[node], items[item_index], output_filenames[item_index], options, initialize);
+
+					const auto & r = results[item_index];
+					std::lock_guard<std::mutex> lock(output_mutex);
+					std::cout << "-> [" << (item_index + 1) << "/" << items.size() << "] " << r.filename << ": ";
+					if (r.error.empty())
+					{
+						std::cout << r.frames << " frames in " << std::fixed << std::setprecision(1) << r.seconds << " seconds (" << r.frames / r.seconds << " FPS, " << r.tracked << " tracked, " << r.duplicates << " duplicates)" << std::endl;
+					}
+					else
+					{
+						std::cout << "ERROR: " << r.error << std::endl;
+					}
+				}
+			});
+	}
+
+	for (auto & t : threads)
+	{
+		t.join();
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+	const std::string report_filename = (std::filesystem::path(options.output_directory) / "batch_report.csv").string();
+	std::ofstream csv(report_filename);
+	csv << "filename,output,status,frames,tracked,trackers,seconds,fps,duplicates" << std::endl;
+
+	size_t total_frames		= 0;
+	size_t total_tracked	= 0;
+	size_t total_duplicates	= 0;
+	size_t failures			= 0;
+	for (const auto & r : results)
+	{
+		csv	<< std::fixed << std::setprecision(3)
+			<< "\"" << r.filename << "\","
+			<< "\"" << r.output_filename << "\","
+			<< (r.error.empty() ? "ok" : "failed") << ","
+			<< r.frames << ","
+			<< r.tracked << ","
+			<< r.trackers << ","
+			<< r.seconds << ","
+			<< (r.seconds > 0.0 ? r.frames / r.seconds : 0.0) << ","
+			<< r.duplicates
+			<< std::endl;
+
+		total_frames		+= r.frames;
+		total_tracked		+= r.tracked;
+		total_duplicates	+= r.duplicates;
+		if (r.error.empty() == false)
+		{
+			failures ++;
+		}
+	}
+	csv	<< "\"total\",,"
+		<< (failures == 0 ? "ok" : "failed") << ","
+		<< total_frames << ","
+		<< total_tracked << ",,"
+		<< seconds << ","
+		<< total_frames / seconds << ","
+		<< total_duplicates
+		<< std::endl;
+
+	std::cout
+		<< "-> batch finished:  " << (items.size() - failures) << " files processed, " << failures << " failed" << std::endl
+		<< "-> " << total_frames << " frames in " << std::fixed << std::setprecision(1) << seconds << " seconds, "
+		<< total_frames / seconds << " FPS overall, " << total_frames / seconds / cores << " FPS per core" << std::endl
+		<< "-> results written to " << options.output_directory << std::endl;
+
+	if (options.numa)
+	{
+		std::vector<const WorkerPool *> all_pools;
+		for (const auto & pool : pools)
+		{
+			all_pools.push_back(pool.get());
+		}
+		show_numa_stats(all_pools);
+	}
+	show_thread_stats();
+
+	return failures == 0;
+}
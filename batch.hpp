@@ -0,0 +1,61 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "thread_budget.hpp"
+#include "tracking_session.hpp"
+
+
+/// The initial position of one object in the first frame of a video.
+struct BatchBox
+{
+	std::string	name;
+	cv::Rect2d	rect;	///< normalized X, Y, W, H coordinates
+};
+
+typedef std::vector<BatchBox> VBatchBoxes;
+
+
+/// One video to process.  See @ref run_batch().
+struct BatchItem
+{
+	std::string	filename;
+	VBatchBoxes	boxes;	///< if empty, the trackers are created the same way as when a single video is shown
+};
+
+typedef std::vector<BatchItem> VBatchItems;
+
+
+/// Settings which control a batch run.  See @ref run_batch().
+struct BatchOptions
+{
+	size_t			cores				= 0;					///< total number of threads to use; zero means one per CPU core
+	size_t			concurrent_files	= 0;					///< files processed at once; zero means one per 4 cores
+	std::string		output_directory	= "batch_results";		///< where the per-file CSV results and the report are written
+	bool			numa				= false;				///< spread the files across the NUMA nodes, each with its own worker pool
+	ThreadPolicy	thread_policy		= ThreadPolicy::split;	///< how the cores are shared between the worker pool and OpenCV
+	size_t			decimation			= 1;					///< only track every Nth frame; the boxes in between are interpolated
+	double			analysis_fps		= 0.0;					///< if not zero, track about this many frames per second instead
+};
+
+
+/** Get the list of videos to process.  If @p path is a directory, every video file within it is used.  Otherwise
+ * @p path is a manifest where each line is a filename optionally followed by any number of initial boxes, each one
+ * given as a name and the normalized X, Y, W, H coordinates, all separated by whitespace.  Blank lines and lines
+ * starting with @p # are ignored.
+ */
+VBatchItems load_batch(const std::string & path);
+
+
+/** Track the objects in every video without displaying anything.  Several files are processed at once:  each file
+ * has a thread which decodes frames and writes results while its trackers run on a worker pool shared by all files, so
+ * decoding, tracking and exporting overlap across files.  The file threads, the worker pool and OpenCV's own threads
+ * together stay within @p BatchOptions::cores threads (see @ref make_thread_budget()).
+ *
+ * Each video gets a CSV file with the position of every object in every frame, in the coordinates of the original
+ * video.  A report with the throughput of each file and of the whole batch is written to @p batch_report.csv.
+ *
+ * @returns @p true if every file was processed successfully.
+ */
+bool run_batch(const VBatchItems & items, const BatchOptions & options, TrackerInitializer initialize);
@@ -0,0 +1,249 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "benchmark.hpp"
+#include "frame_arena.hpp"
+#include "huge_pages.hpp"
+#include "perf_counters.hpp"
+#include "stats.hpp"
+#include "thread_budget.hpp"
+
+
+BenchmarkResults run_benchmark(TrackingSession & session, const size_t number_of_frames)
+{
+	std::cout << "-> benchmark processing " << number_of_frames << " frames with " << session.get_tracks().size() << " trackers" << std::endl;
+
+	LatencySamples latencies;
+	const size_t duplicates_start = session.duplicate_frames();
+	const ArenaStats arena_start = get_arena_stats();
+	// the trackers run on the pool's workers, which already exist, so their own counters are used
+	uint64_t dtlb_loads_start	= 0;
+	uint64_t dtlb_misses_start	= 0;
+	session.get_pool().get_dtlb_counts(dtlb_loads_start, dtlb_misses_start);
+	uint64_t llc_loads_start	= 0;
+	uint64_t llc_misses_start	= 0;
+	session.get_pool().get_llc_counts(llc_loads_start, llc_misses_start);
+	const size_t steals_start = session.get_pool().get_steal_count();
+	const auto start_time = std::chrono::high_resolution_clock::now();
+
+	// keep a few frames queued so all the worker threads have something to do
+	const size_t frames_in_flight = 2;
+	std::deque<std::chrono::high_resolution_clock::time_point> push_times;
+	size_t frames_pushed = 0;
+	size_t frames_pulled = 0;
+	size_t max_runnable_threads = 0;
+
+	while (frames_pulled < number_of_frames)
+	{
+		while (frames_pushed < number_of_frames and session.frames_in_flight() < frames_in_flight)
+		{
+			cv::Mat mat;
+			if (session.read_frame(mat) == false)
+			{
+				if (session.cap.rewind() == false or session.read_frame(mat) == false)
+				{
+					throw std::runtime_error("failed to loop " + session.name);
+				}
+			}
+
+			push_times.push_back(std::chrono::high_resolution_clock::now());
+			session.push_frame(mat);
+			frames_pushed ++;
+		}
+
+		FrameResults frame_results;
+		if (session.pull_results(frame_results) == false)
+		{
+			throw std::runtime_error("benchmark ran out of frames");
+		}
+		latencies.add(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - push_times.front()).count());
+		push_times.pop_front();
+		frames_pulled ++;
+
+		if (frames_pulled % 8 == 0)
+		{
+			// reading /proc isn't free, so only check every few frames
+			max_runnable_threads = std::max(max_runnable_threads, get_runnable_thread_count());
+		}
+	}
+
+	BenchmarkResults results;
+	results.frames				= number_of_frames;
+	results.seconds				= std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+	results.fps					= number_of_frames / results.seconds;
+	results.mean_milliseconds	= latencies.mean();
+	results.p50_milliseconds	= latencies.quantile(0.50);
+	results.p99_milliseconds	= latencies.quantile(0.99);
+
+	results.max_runnable_threads	= max_runnable_threads;
+	results.duplicate_ratio			= static_cast<double>(session.duplicate_frames() - duplicates_start) / number_of_frames;
+
+	uint64_t dtlb_loads_end		= 0;
+	uint64_t dtlb_misses_end	= 0;
+	session.get_pool().get_dtlb_counts(dtlb_loads_end, dtlb_misses_end);
+	const double loads	= dtlb_loads_end	- dtlb_loads_start;
+	const double misses	= dtlb_misses_end	- dtlb_misses_start;
+	results.dtlb_misses_per_frame	= misses / number_of_frames;
+	results.dtlb_miss_rate			= (loads > 0.0 ? misses / loads : 0.0);
+
+	uint64_t llc_loads_end	= 0;
+	uint64_t llc_misses_end	= 0;
+	session.get_pool().get_llc_counts(llc_loads_end, llc_misses_end);
+	const double llc_loads	= llc_loads_end		- llc_loads_start;
+	const double llc_misses	= llc_misses_end	- llc_misses_start;
+	results.llc_misses_per_frame	= llc_misses / number_of_frames;
+	results.llc_miss_rate			= (llc_loads > 0.0 ? llc_misses / llc_loads : 0.0);
+	results.steals_per_frame		= static_cast<double>(session.get_pool().get_steal_count() - steals_start) / number_of_frames;
+
+	const ArenaStats arena_end = get_arena_stats();
+	results.arena_allocations_per_frame	= static_cast<double>(arena_end.arena_allocations	- arena_start.arena_allocations	) / number_of_frames;
+	results.heap_allocations_per_frame	= static_cast<double>(arena_end.heap_allocations	- arena_start.heap_allocations	) / number_of_frames;
+	results.new_chunks_per_frame		= static_cast<double>(arena_end.new_chunks			- arena_start.new_chunks		) / number_of_frames;
+
+	std::cout
+		<< "-> benchmark: " << results.frames << " frames in " << std::fixed << std::setprecision(3) << results.seconds << " seconds, "
+		<< results.fps << " FPS, "
+		<< results.mean_milliseconds << " ms/frame (p50=" << results.p50_milliseconds << " ms, p99=" << results.p99_milliseconds << " ms)"
+		<< std::endl
+		<< "-> at most " << results.max_runnable_threads << " runnable threads"
+		<< ", " << std::setprecision(1) << (100.0 * results.duplicate_ratio) << "% duplicate frames skipped" << std::endl;
+
+	if (frame_arena_installed())
+	{
+		std::cout
+			<< "-> Mat allocations per frame: " << results.arena_allocations_per_frame << " from the arena, "
+			<< results.heap_allocations_per_frame << " from the heap, "
+			<< results.new_chunks_per_frame << " new arena chunks"
+			<< " (" << (arena_end.pinned_chunks - arena_start.pinned_chunks) << " chunks pinned)"
+			<< std::endl;
+	}
+
+	if (dtlb_loads_end > 0)
+	{
+		std::cout
+			<< "-> worker dTLB load misses: " << std::setprecision(0) << results.dtlb_misses_per_frame << " per frame"
+			<< " (" << std::setprecision(3) << (100.0 * results.dtlb_miss_rate) << "% of loads)"
+			<< std::endl;
+	}
+	else
+	{
+		std::cout << "-> dTLB counters are not available (check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+	}
+
+	if (llc_loads_end > 0)
+	{
+		std::cout
+			<< "-> worker LLC load misses: " << std::setprecision(0) << results.llc_misses_per_frame << " per frame"
+			<< " (" << std::setprecision(3) << (100.0 * results.llc_miss_rate) << "% of loads), "
+			<< std::setprecision(2) << results.steals_per_frame << " stolen tracker updates per frame"
+			<< std::endl;
+	}
+
+	if (huge_page_mode() != HugePageMode::off)
+	{
+		const HugePageStats stats = get_huge_page_stats();
+		std::cout
+			<< "-> huge pages: " << stats.hugetlb_mappings << " hugetlb mappings, "
+			<< stats.thp_mappings << " THP mappings, "
+			<< stats.fallbacks << " fallbacks, "
+			<< stats.reused << " reused, "
+			<< std::setprecision(1) << (stats.anon_huge_bytes / 1048576.0) << " MiB backed by THP"
+			<< std::endl;
+	}
+
+	return results;
+}
+
+
+void compare_thread_policies(const std::string & filename, const size_t cores, const size_t number_of_frames, TrackerInitializer initialize)
+{
+	struct Row
+	{
+		ThreadBudget		budget;
+		BenchmarkResults	results;
+	};
+	std::vector<Row> rows;
+
+	for (const auto policy : {ThreadPolicy::workers, ThreadPolicy::opencv, ThreadPolicy::split})
+	{
+		const ThreadBudget budget = make_thread_budget(cores, policy);
+		apply_thread_budget(budget);
+		show_thread_budget(budget);
+
+		WorkerPool pool(budget.worker_threads);
+		TrackingSession session(pool);
+		session.open(filename, TrackingSession::default_maximum_size, false);
+		cv::Mat mat = session.get_first_frame();
+		initialize(session, mat);
+
+		rows.push_back({budget, run_benchmark(session, number_of_frames)});
+	}
+
+	std::cout << "-> thread policy comparison (" << rows.front().budget.cores << " cores):" << std::endl;
+	for (const auto & row : rows)
+	{
+		std::cout
+			<< "   " << std::left << std::setw(8) << to_string(row.budget.policy) << std::right
+			<< " workers=" << std::setw(3) << row.budget.worker_threads
+			<< " opencv=" << std::setw(3) << row.budget.opencv_threads
+			<< std::fixed << std::setprecision(2)
+			<< "  " << std::setw(8) << row.results.fps << " FPS"
+			<< "  p50=" << std::setw(7) << row.results.p50_milliseconds << " ms"
+			<< "  p99=" << std::setw(7) << row.results.p99_milliseconds << " ms"
+			<< "  max runnable=" << row.results.max_runnable_threads
+			<< std::endl;
+	}
+
+	return;
+}
+
+
+void compare_tracker_assignments(const std::string & filename, const size_t cores, const size_t number_of_frames, TrackerInitializer initialize)
+{
+	struct Row
+	{
+		TrackerAssignment	assignment;
+		BenchmarkResults	results;
+	};
+	std::vector<Row> rows;
+
+	const ThreadBudget budget = make_thread_budget(cores, ThreadPolicy::split);
+	apply_thread_budget(budget);
+	show_thread_budget(budget);
+
+	const TrackerAssignment original = TrackingSession::default_tracker_assignment;
+	for (const auto assignment : {TrackerAssignment::any, TrackerAssignment::tiles})
+	{
+		TrackingSession::default_tracker_assignment = assignment;
+
+		WorkerPool pool(budget.worker_threads);
+		TrackingSession session(pool);
+		session.open(filename, TrackingSession::default_maximum_size, false);
+		cv::Mat mat = session.get_first_frame();
+		initialize(session, mat);
+
+		rows.push_back({assignment, run_benchmark(session, number_of_frames)});
+	}
+	TrackingSession::default_tracker_assignment = original;
+
+	std::cout << "-> tracker assignment comparison (" << budget.worker_threads << " workers, tiles of " << TrackingSession::default_tile_size << " pixels):" << std::endl;
+	for (const auto & row : rows)
+	{
+		std::cout
+			<< "   " << std::left << std::setw(6) << to_string(row.assignment) << std::right
+			<< std::fixed << std::setprecision(2)
+			<< "  " << std::setw(8) << row.results.fps << " FPS"
+			<< "  p50=" << std::setw(7) << row.results.p50_milliseconds << " ms"
+			<< "  LLC misses/frame=" << std::setw(10) << std::setprecision(0) << row.results.llc_misses_per_frame
+			<< "  LLC miss rate=" << std::setw(6) << std::setprecision(2) << (100.0 * row.results.llc_miss_rate) << "%"
+			<< "  steals/frame=" << row.results.steals_per_frame
+			<< std::endl;
+	}
+	if (rows.front().results.llc_misses_per_frame == 0.0)
+	{
+		std::cout << "-> LLC counters are not available (check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+	}
+
+	return;
+}
@@ -0,0 +1,49 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "tracking_session.hpp"
+
+
+/// Results from @ref run_benchmark().
+struct BenchmarkResults
+{
+	size_t	frames;							///< number of frames processed
+	double	seconds;						///< total wall time
+	double	fps;							///< frames per second
+	double	mean_milliseconds;				///< average time from pushing a frame to pulling its results
+	double	p50_milliseconds;
+	double	p99_milliseconds;
+	double	arena_allocations_per_frame;	///< Mats served from the per-frame arena (zero unless the arena is installed)
+	double	heap_allocations_per_frame;		///< Mats which went to the heap (zero unless the arena is installed)
+	double	new_chunks_per_frame;			///< arena growth; should be zero in the steady state
+	double	dtlb_misses_per_frame;			///< dTLB load misses of the worker threads; zero if the hardware counters are not available
+	double	dtlb_miss_rate;					///< fraction of dTLB loads which missed
+	double	llc_misses_per_frame;			///< last level cache load misses of the worker threads; zero if the counters are not available
+	double	llc_miss_rate;					///< fraction of the workers' last level cache loads which missed
+	double	steals_per_frame;				///< tracker updates which ran on another worker than the one they were queued on
+	size_t	max_runnable_threads;			///< most threads seen running or waiting for a CPU at the same time
+	double	duplicate_ratio;				///< fraction of the frames which repeated the previous one and weren't tracked
+};
+
+
+/** Process @p number_of_frames frames as fast as possible without displaying anything, looping the input if needed.
+ * This is the workload used to train profile-guided builds and to compare one build or setting against another, so
+ * it should be run on the deterministic "synthetic" input whenever results need to be compared.
+ */
+BenchmarkResults run_benchmark(TrackingSession & session, const size_t number_of_frames);
+
+
+/** Run the benchmark once with each @ref ThreadPolicy, using a new worker pool and session each time, and show the
+ * results side by side.  @p cores is the thread budget; zero means all of the CPUs.
+ */
+void compare_thread_policies(const std::string & filename, const size_t cores, const size_t number_of_frames, TrackerInitializer initialize);
+
+
+/** Run the benchmark once with each @ref TrackerAssignment, using a new worker pool and session each time, and show the
+ * throughput and the last level cache misses of the workers side by side.  @p cores is the thread budget; zero means
+ * all of the CPUs.  The difference is largest with many objects close together and the workers pinned with
+ * @p --worker-cpus, so each worker stays on one core.
+ */
+void compare_tracker_assignments(const std::string & filename, const size_t cores, const size_t number_of_frames, TrackerInitializer initialize);
@@ -0,0 +1,67 @@
+#!/bin/bash
+# CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+# MIT license applies.  See "license.txt" for details.
+#
+# Build a plain Release binary and a PGO+LTO binary trained on the headless synthetic benchmark, then report the uplift.
+#
+# usage:  ./build_pgo.sh [march]
+#
+#   march		optional -march target for the optimized build, such as "native" or "x86-64-v3"
+#
+# Environment variables:
+#
+#   BUILD_DIR	where the builds are created (default: ./build_pgo)
+#   INPUT		input used to train and benchmark (default: synthetic:1280x720)
+#   FRAMES		number of frames in each benchmark run (default: 600)
+
+set -e
+
+SOURCE_DIR="$(cd "$(dirname "$0")" && pwd)"
+BUILD_DIR="${BUILD_DIR:-${SOURCE_DIR}/build_pgo}"
+INPUT="${INPUT:-synthetic:1280x720}"
+FRAMES="${FRAMES:-600}"
+MARCH="${1:-}"
+PROFILE_DIR="${BUILD_DIR}/profile"
+
+build()
+{
+	local dir="$1"
+	shift
+	cmake -S "${SOURCE_DIR}" -B "${dir}" "$@" > "${dir}.log" 2>&1
+	cmake --build "${dir}" -j"$(nproc)" >> "${dir}.log" 2>&1 || { echo "build failed, see ${dir}.log"; exit 1; }
+}
+
+benchmark()
+{
+	"$1/CSRTExample" --benchmark "${FRAMES}" "${INPUT}" | grep -- "-> benchmark:" | sed -E 's/.* ([0-9.]+) FPS.*/\1/'
+}
+
+mkdir -p "${BUILD_DIR}"
+
+echo "-> building plain Release"
+build "${BUILD_DIR}/release" -DCSRT_PGO=OFF -DCSRT_LTO=OFF -DCSRT_MARCH=
+
+# GCC names each profile after the full path of the object file, so the instrumented and the optimized binaries must be
+# built in the same directory or the optimized build won't find any of the profiles
+echo "-> building instrumented binary"
+rm -rf "${PROFILE_DIR}" "${BUILD_DIR}/optimized"
+build "${BUILD_DIR}/optimized" -DCSRT_PGO=GENERATE -DCSRT_PGO_DIR="${PROFILE_DIR}" -DCSRT_LTO=OFF -DCSRT_MARCH="${MARCH}"
+
+echo "-> training on ${FRAMES} frames of ${INPUT}"
+"${BUILD_DIR}/optimized/CSRTExample" --benchmark "${FRAMES}" "${INPUT}" > /dev/null
+if ls "${PROFILE_DIR}"/*.profraw > /dev/null 2>&1
+then
+	# clang writes raw profiles which must be merged
+	llvm-profdata merge -output="${PROFILE_DIR}/default.profdata" "${PROFILE_DIR}"/*.profraw
+fi
+
+echo "-> building PGO+LTO binary${MARCH:+ with -march=${MARCH}}"
+build "${BUILD_DIR}/optimized" -DCSRT_PGO=USE -DCSRT_PGO_DIR="${PROFILE_DIR}" -DCSRT_LTO=ON -DCSRT_MARCH="${MARCH}"
+
+echo "-> benchmarking"
+RELEASE_FPS="$(benchmark "${BUILD_DIR}/release")"
+OPTIMIZED_FPS="$(benchmark "${BUILD_DIR}/optimized")"
+
+echo "-> plain Release: ${RELEASE_FPS} FPS"
+echo "-> PGO+LTO:       ${OPTIMIZED_FPS} FPS"
+awk -v a="${RELEASE_FPS}" -v b="${OPTIMIZED_FPS}" 'BEGIN { if (a > 0) printf "-> uplift:        %+.1f%%\n", 100.0 * (b - a) / a }'
@@ -0,0 +1,302 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "capture_backend.hpp"
+#include <mutex>
+#include <set>
+
+
+static CaptureBackendOptions settings;
+
+/// Held while the cache is read or written and while backends are probed.
+static std::mutex probe_mutex;
+
+/// Codecs and resolutions which have already been probed by this process, so a forced probe only happens once each.
+static std::set<std::pair<std::string, std::pair<int, int>>> probed;
+
+
+/// One entry of the cache file:  the fastest backend for one kind of video.
+struct CachedBackend
+{
+	std::string	codec;
+	cv::Size	size;
+	std::string	backend;
+	double		fps;
+};
+
+typedef std::vector<CachedBackend> VCachedBackends;
+
+
+void set_capture_backend_options(const CaptureBackendOptions & options)
+{
+	if (options.backend != "auto")
+	{
+		// fail now on a typo rather than when the first video is opened
+		to_capture_backend(options.backend);
+	}
+	if (options.probe_frames == 0)
+	{
+		throw std::invalid_argument("backends cannot be probed with zero frames");
+	}
+
+	settings = options;
+
+	return;
+}
+
+
+const CaptureBackendOptions & get_capture_backend_options()
+{
+	return settings;
+}
+
+
+static std::string to_lowercase(std::string str)
+{
+	std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+
+	return str;
+}
+
+
+int to_capture_backend(const std::string & name)
+{
+	const std::string lowercase = to_lowercase(name);
+	if (lowercase == "any")
+	{
+		return cv::CAP_ANY;
+	}
+
+	std::string names = "any";
+	for (const auto backend : cv::videoio_registry::getStreamBackends())
+	{
+		const std::string backend_name = cv::videoio_registry::getBackendName(backend);
+		if (to_lowercase(backend_name) == lowercase)
+		{
+			return backend;
+		}
+		names += ", " + backend_name;
+	}
+
+	throw std::invalid_argument("unknown capture backend \"" + name + "\" (this build of OpenCV has " + names + ")");
+}
+
+
+std::string capture_backend_name(const int backend)
+{
+	if (backend == cv::CAP_ANY)
+	{
+		return "any";
+	}
+
+	return cv::videoio_registry::getBackendName(static_cast<cv::VideoCaptureAPIs>(backend));
+}
+
+
+/// Time one backend reading @p frames frames of @p filename.
+static CaptureBackendTiming time_capture_backend(const std::string & filename, const int backend, const size_t frames)
+{
+	CaptureBackendTiming timing = {backend, 0, 0.0};
+
+	try
+	{
+		cv::VideoCapture cap;
+		cv::Mat mat;
+		// the first read sets up the decoder and its threads, which has nothing to do with how fast it decodes
+		if (cap.open(filename, backend) and cap.read(mat) and mat.empty() == false)
+		{
+			const auto start_time = std::chrono::high_resolution_clock::now();
+			while (timing.frames < frames and cap.read(mat) and mat.empty() == false)
+			{
+				timing.frames ++;
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+			if (timing.frames > 0 and seconds > 0.0)
+			{
+				timing.fps = timing.frames / seconds;
+			}
+		}
+	}
+	catch (const cv::Exception & e)
+	{
+		// some backends throw rather than fail to open a file they don't understand
+	}
+
+	return timing;
+}
+
+
+VCaptureBackendTimings probe_capture_backends(const std::string & filename, const size_t frames)
+{
+	const std::vector<cv::VideoCaptureAPIs> backends = cv::videoio_registry::getStreamBackends();
+
+	/* Whichever backend goes first reads the file from disk while the others read it from the page cache, so each one
+	 * is timed twice, in the opposite order the second time, and the better of its two runs is kept.
+	 */
+	VCaptureBackendTimings timings;
+	for (const auto backend : backends)
+	{
+		timings.push_back(time_capture_backend(filename, backend, frames));
+	}
+	for (size_t idx = timings.size(); idx > 0; idx --)
+	{
+		const CaptureBackendTiming timing = time_capture_backend(filename, backends[idx - 1], frames);
+		if (timing.fps > timings[idx - 1].fps)
+		{
+			timings[idx - 1] = timing;
+		}
+	}
+
+	std::sort(timings.begin(), timings.end(), [](const CaptureBackendTiming & lhs, const CaptureBackendTiming & rhs) { return lhs.fps > rhs.fps; });
+
+	return timings;
+}
+
+
+static VCachedBackends load_cache(const std::string & filename)
+{
+	VCachedBackends cache;
+
+	cv::FileStorage fs;
+	try
+	{
+		fs.open(filename, cv::FileStorage::READ);
+	}
+	catch (const cv::Exception & e)
+	{
+		std::cout << "-> ignoring the capture backend cache " << filename << " since it cannot be parsed" << std::endl;
+	}
+	if (fs.isOpened() == false)
+	{
+		return cache;
+	}
+
+	for (const auto & node : fs["backends"])
+	{
+		if (node.isMap() and node["codec"].isString() and node["backend"].isString())
+		{
+			cache.push_back({node["codec"].string(), cv::Size(static_cast<int>(node["width"]), static_cast<int>(node["height"])), node["backend"].string(), node["fps"].real()});
+		}
+	}
+
+	return cache;
+}
+
+
+static void save_cache(const std::string & filename, const VCachedBackends & cache)
+{
+	cv::FileStorage fs(filename, cv::FileStorage::WRITE);
+	if (fs.isOpened() == false)
+	{
+		std::cout << "-> failed to write the capture backend cache " << filename << std::endl;
+		return;
+	}
+
+	fs.writeComment("fastest capture backend for each codec and resolution, measured with --capture-backend auto");
+	fs << "backends" << "[";
+	for (const auto & entry : cache)
+	{
+		fs	<< "{:"
+			<< "codec"		<< entry.codec
+			<< "width"		<< entry.size.width
+			<< "height"		<< entry.size.height
+			<< "backend"	<< entry.backend
+			<< "fps"		<< entry.fps
+			<< "}";
+	}
+	fs << "]";
+
+	return;
+}
+
+
+/// The four characters of the codec, such as @p "avc1" or @p "hevc".  Anything unprintable becomes an underscore.
+static std::string get_codec(const cv::VideoCapture & cap)
+{
+	const int fourcc = cap.get(cv::VideoCaptureProperties::CAP_PROP_FOURCC);
+
+	std::string codec;
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		const char c = (fourcc >> shift) & 0xff;
+		codec += (std::isalnum(static_cast<unsigned char>(c)) ? c : '_');
+	}
+
+	return codec;
+}
+
+
+int choose_capture_backend(const std::string & filename)
+{
+	if (settings.backend != "auto")
+	{
+		return to_capture_backend(settings.backend);
+	}
+
+	if (filename.compare(0, 9, "synthetic") == 0)
+	{
+		return cv::CAP_ANY;
+	}
+
+	// find out what kind of video this is
+	cv::VideoCapture cap;
+	if (cap.open(filename) == false or cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_COUNT) <= 0)
+	{
+		return cv::CAP_ANY;
+	}
+	const std::string codec	= get_codec(cap);
+	const cv::Size size		(cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_WIDTH), cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_HEIGHT));
+	cap.release();
+
+	std::lock_guard<std::mutex> lock(probe_mutex);
+
+	VCachedBackends cache = load_cache(settings.cache_filename);
+	auto iter = std::find_if(cache.begin(), cache.end(), [&](const CachedBackend & entry) { return entry.codec == codec and entry.size == size; });
+	const auto key = std::make_pair(codec, std::make_pair(size.width, size.height));
+	if (iter != cache.end() and (settings.probe == false or probed.count(key)))
+	{
+		try
+		{
+			return to_capture_backend(iter->backend);
+		}
+		catch (const std::invalid_argument & e)
+		{
+			// the cache was written by a build of OpenCV with other backends, so measure again
+		}
+	}
+
+	std::cout << "-> probing the capture backends with " << settings.probe_frames << " frames of " << filename << " (" << codec << ", " << size.width << " x " << size.height << ")" << std::endl;
+	const VCaptureBackendTimings timings = probe_capture_backends(filename, settings.probe_frames);
+	probed.insert(key);
+	for (const auto & timing : timings)
+	{
+		std::cout << "-> " << capture_backend_name(timing.backend) << ": ";
+		if (timing.fps > 0.0)
+		{
+			std::cout << std::fixed << std::setprecision(1) << timing.fps << " FPS over " << timing.frames << " frames" << std::endl;
+		}
+		else
+		{
+			std::cout << "cannot read this video" << std::endl;
+		}
+	}
+
+	if (timings.empty() or timings.front().fps <= 0.0)
+	{
+		return cv::CAP_ANY;
+	}
+
+	const CachedBackend fastest = {codec, size, capture_backend_name(timings.front().backend), timings.front().fps};
+	if (iter != cache.end())
+	{
+		*iter = fastest;
+	}
+	else
+	{
+		cache.push_back(fastest);
+	}
+	save_cache(settings.cache_filename, cache);
+
+	return timings.front().backend;
+}
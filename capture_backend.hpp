@@ -0,0 +1,59 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+
+/// How the @p cv::VideoCapture backend is chosen when a video is opened.  See @ref choose_capture_backend().
+struct CaptureBackendOptions
+{
+	std::string	backend			= "any";					///< @p "any", @p "auto", or the name of a backend such as @p "FFMPEG"
+	std::string	cache_filename	= "capture_backends.yaml";	///< fastest backend measured for each codec and resolution
+	size_t		probe_frames	= 300;						///< frames decoded by each backend when it is measured
+	bool		probe			= false;					///< measure again (once per run) even if the cache already has an answer
+};
+
+
+/// How fast one backend decoded one video.  See @ref probe_capture_backends().
+struct CaptureBackendTiming
+{
+	int		backend;	///< one of the @p cv::VideoCaptureAPIs
+	size_t	frames;		///< frames which were decoded; fewer than requested if the video is short
+	double	fps;		///< zero if the backend failed to open the video
+};
+
+typedef std::vector<CaptureBackendTiming> VCaptureBackendTimings;
+
+
+void set_capture_backend_options(const CaptureBackendOptions & options);
+
+const CaptureBackendOptions & get_capture_backend_options();
+
+/** Convert @p "any" or a backend name such as @p "FFMPEG" or @p "gstreamer" to one of the @p cv::VideoCaptureAPIs.
+ * Names are not case-sensitive.  Throws if this build of OpenCV doesn't have a backend with that name.
+ */
+int to_capture_backend(const std::string & name);
+
+std::string capture_backend_name(const int backend);
+
+/** Open @p filename with every video backend this build of OpenCV has, and time how long each one takes to read
+ * @p frames frames after the first (including the conversion to BGR, like the pipeline does).  Each backend is timed
+ * twice, in reverse order the second time, and its faster run is kept.  The results are sorted with the fastest
+ * backend first.
+ */
+VCaptureBackendTimings probe_capture_backends(const std::string & filename, const size_t frames);
+
+/** Decide which backend should be used to open @p filename, according to @ref set_capture_backend_options():
+ *
+ * - @p "any" lets OpenCV choose, which is what @p cv::VideoCapture::open() does by default;
+ * - a backend name always uses that backend;
+ * - @p "auto" uses the fastest backend measured for videos with the same codec and resolution.  If that combination
+ *   hasn't been measured yet (or @p CaptureBackendOptions::probe is set) the backends are probed and the winner is
+ *   saved in the cache file for later runs.
+ *
+ * Cameras, streams and the synthetic generator have no frame count to probe and always use @p cv::CAP_ANY in auto
+ * mode.  Probing is serialized, so concurrent sessions don't distort each other's measurements.
+ */
+int choose_capture_backend(const std::string & filename);
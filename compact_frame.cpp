@@ -0,0 +1,57 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "compact_frame.hpp"
+
+
+CompactFrame::CompactFrame(const cv::Mat & mat) :
+	frame_size(mat.size())
+{
+	if (mat.type() == CV_8UC3 and mat.cols % 2 == 0 and mat.rows % 2 == 0)
+	{
+		cv::cvtColor(mat, data, cv::COLOR_BGR2YUV_I420);
+		yuv = true;
+	}
+	else
+	{
+		data = mat.clone();
+	}
+
+	return;
+}
+
+
+cv::Mat CompactFrame::luma() const
+{
+	if (yuv)
+	{
+		return data.rowRange(0, frame_size.height);
+	}
+
+	cv::Mat grey;
+	if (data.channels() == 3)
+	{
+		cv::cvtColor(data, grey, cv::COLOR_BGR2GRAY);
+	}
+	else
+	{
+		grey = data;
+	}
+
+	return grey;
+}
+
+
+cv::Mat CompactFrame::bgr() const
+{
+	if (yuv == false)
+	{
+		return data;
+	}
+
+	cv::Mat mat;
+	cv::cvtColor(data, mat, cv::COLOR_YUV2BGR_I420);
+
+	return mat;
+}
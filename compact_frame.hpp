@@ -0,0 +1,46 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+
+/** A frame stored as planar YUV 4:2:0 (I420):  a full resolution luma plane followed by the U and V planes at half the
+ * width and half the height, for 1.5 bytes per pixel instead of the 3 bytes of BGR.  Frames are kept in this form while
+ * they wait in the pipeline's queues, and are only converted back to BGR by the stages which need colour.  The luma
+ * plane is the greyscale image, so trackers which work in grey can use it without any conversion at all.
+ *
+ * Frames which are not 8-bit BGR, or which have an odd width or height and so cannot be subsampled, are kept as they are.
+ */
+class CompactFrame
+{
+	public:
+
+		CompactFrame() = default;
+
+		/// Convert @p mat from BGR.  The original mat is not referenced afterwards.
+		explicit CompactFrame(const cv::Mat & mat);
+
+		bool empty() const { return data.empty(); }
+
+		/// @p true if the frame is stored as I420, @p false if it was kept as given.
+		bool is_yuv() const { return yuv; }
+
+		cv::Size size() const { return frame_size; }
+
+		/// Bytes used by the pixels.
+		size_t bytes() const { return data.total() * data.elemSize(); }
+
+		/// The greyscale image.  This is a view of the luma plane, so nothing is copied unless the frame isn't I420.
+		cv::Mat luma() const;
+
+		/// Convert the whole frame back to BGR.  Each call converts again, so callers which need it more than once should keep it.
+		cv::Mat bgr() const;
+
+	private:
+
+		cv::Mat		data;			///< (height * 3 / 2) rows of @p width bytes when @ref yuv is set
+		cv::Size	frame_size;
+		bool		yuv = false;
+};
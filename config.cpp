@@ -0,0 +1,406 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "config.hpp"
+#include <cmath>
+#include <limits>
+#include <set>
+
+
+Backpressure to_backpressure(const std::string & name)
+{
+	if (name == "block")		return Backpressure::block;
+	if (name == "drop_late")	return Backpressure::drop_late;
+
+	throw std::invalid_argument("backpressure must be block or drop_late (not \"" + name + "\")");
+}
+
+
+std::string to_string(const Backpressure backpressure)
+{
+	switch (backpressure)
+	{
+		case Backpressure::block:		return "block";
+		case Backpressure::drop_late:	return "drop_late";
+	}
+
+	return "unknown";
+}
+
+
+PipelineConfig::PipelineConfig() :
+	tracking_size(1024, 768),
+	enable_object_tracking(true),
+	threads(0),
+	frames_in_flight(2),
+	backpressure(Backpressure::block),
+	duplicate_tolerance(-1),
+	motion_compensation(false),
+	compact_frames(false),
+	tracker_assignment(TrackerAssignment::any),
+	tile_size(256),
+	capture_backend("any")
+{
+	profiles["default"] = TrackerProfile();
+
+	return;
+}
+
+
+/// Make sure @p node only has the keys in @p allowed.  @p where is used in the error message.
+static void check_keys(const cv::FileNode & node, const std::set<std::string> & allowed, const std::string & where)
+{
+	if (node.isMap() == false)
+	{
+		throw std::invalid_argument(where + " must be a map");
+	}
+
+	for (const auto & key : node.keys())
+	{
+		if (allowed.count(key) == 0)
+		{
+			std::string names;
+			for (const auto & name : allowed)
+			{
+				names += (names.empty() ? "" : ", ") + name;
+			}
+			throw std::invalid_argument("unknown key \"" + key + "\" in " + where + " (expected one of " + names + ")");
+		}
+	}
+
+	return;
+}
+
+
+static double get_number(const cv::FileNode & node, const std::string & where, const double minimum, const double maximum)
+{
+	if (node.isInt() == false and node.isReal() == false)
+	{
+		throw std::invalid_argument(where + " must be a number");
+	}
+
+	const double value = node.real();
+	if (value < minimum or value > maximum)
+	{
+		throw std::invalid_argument(where + " must be between " + std::to_string(minimum) + " and " + std::to_string(maximum) + " (not " + std::to_string(value) + ")");
+	}
+
+	return value;
+}
+
+
+/// Same as @ref get_number(), but @p 2.5 is rejected rather than truncated.
+static int get_integer(const cv::FileNode & node, const std::string & where, const double minimum, const double maximum)
+{
+	const double value = get_number(node, where, minimum, maximum);
+	if (value != std::floor(value))
+	{
+		throw std::invalid_argument(where + " must be a whole number (not " + std::to_string(value) + ")");
+	}
+
+	return value;
+}
+
+
+static std::string get_string(const cv::FileNode & node, const std::string & where)
+{
+	if (node.isString() == false)
+	{
+		throw std::invalid_argument(where + " must be a string");
+	}
+
+	return node.string();
+}
+
+
+/// A size is written as @p [width, height].
+static cv::Size get_size(const cv::FileNode & node, const std::string & where)
+{
+	if (node.isSeq() == false or node.size() != 2)
+	{
+		throw std::invalid_argument(where + " must be [width, height]");
+	}
+
+	return cv::Size(get_number(node[0], where, 0, 16384), get_number(node[1], where, 0, 16384));
+}
+
+
+/// A polygon is written as a list of normalized corners such as @p [[0.1, 0.2], [0.9, 0.2], [0.5, 0.8]].
+static Polygon get_polygon(const cv::FileNode & node, const std::string & where)
+{
+	if (node.isSeq() == false)
+	{
+		throw std::invalid_argument(where + " must be a list of [x, y] corners");
+	}
+
+	Polygon polygon;
+	for (const auto & corner : node)
+	{
+		if (corner.isSeq() == false or corner.size() != 2)
+		{
+			throw std::invalid_argument(where + " corners must be [x, y]");
+		}
+		polygon.push_back(cv::Point2d(get_number(corner[0], where + " x", 0, 1), get_number(corner[1], where + " y", 0, 1)));
+	}
+
+	return polygon;
+}
+
+
+/// Valid values for one of the numeric CSRT parameters.
+struct CsrtRange
+{
+	std::string	key;
+	double		minimum;	///< the value must be greater than this
+	double		maximum;	///< and no more than this
+	bool		integer;
+};
+
+
+/** OpenCV reads the CSRT parameters without checking them, and values such as a negative padding or zero scales only
+ * fail (or crash) once the first object is tracked.
+ */
+static void check_csrt_params(const cv::FileNode & csrt, const std::string & where)
+{
+	static const double unbounded = std::numeric_limits<double>::max();
+	static const std::vector<CsrtRange> ranges =
+	{
+		{"kaiser_alpha"				, 0.0, unbounded, false	},
+		{"cheb_attenuation"			, 0.0, unbounded, false	},
+		{"padding"					, 0.0, unbounded, false	},
+		{"template_size"			, 0.0, unbounded, false	},
+		{"gsl_sigma"				, 0.0, unbounded, false	},
+		{"hog_orientations"			, 0.0, unbounded, false	},
+		{"hog_clip"					, 0.0, unbounded, false	},
+		{"num_hog_channels_used"	, 0.0, 1000.0	, true	},
+		{"filter_lr"				, 0.0, 1.0		, false	},
+		{"weights_lr"				, 0.0, 1.0		, false	},
+		{"admm_iterations"			, 0.0, 1000.0	, true	},
+		{"number_of_scales"			, 0.0, 1000.0	, true	},
+		{"scale_sigma_factor"		, 0.0, unbounded, false	},
+		{"scale_model_max_area"		, 0.0, unbounded, false	},
+		{"scale_lr"					, 0.0, 1.0		, false	},
+		{"scale_step"				, 1.0, unbounded, false	},
+		{"histogram_bins"			, 0.0, 1000.0	, true	},
+		{"background_ratio"			, 0.0, 1000.0	, true	},
+		{"histogram_lr"				, 0.0, 1.0		, false	},
+		{"psr_threshold"			, 0.0, unbounded, false	}
+	};
+
+	for (const auto & range : ranges)
+	{
+		const cv::FileNode node = csrt[range.key];
+		if (node.empty())
+		{
+			continue;
+		}
+
+		const std::string name = where + " csrt " + range.key;
+		const double value = (range.integer ? get_integer(node, name, range.minimum, range.maximum) : get_number(node, name, range.minimum, range.maximum));
+		if (value <= range.minimum)
+		{
+			throw std::invalid_argument(name + " must be greater than " + std::to_string(range.minimum) + " (not " + std::to_string(value) + ")");
+		}
+	}
+
+	if (not csrt["window_function"].empty())
+	{
+		const std::string window_function = get_string(csrt["window_function"], where + " csrt window_function");
+		if (window_function != "hann" and window_function != "cheb" and window_function != "kaiser")
+		{
+			throw std::invalid_argument(where + " csrt window_function must be hann, cheb or kaiser (not \"" + window_function + "\")");
+		}
+	}
+
+	return;
+}
+
+
+static TrackerProfile get_profile(const cv::FileNode & node, const std::string & name)
+{
+	const std::string where = "profile \"" + name + "\"";
+	check_keys(node, {"tracker", "csrt", "priority", "update_interval", "loss_seconds", "colour"}, where);
+
+	TrackerProfile profile;
+	profile.name = name;
+	if (not node["tracker"].empty())			profile.tracker_type	= get_string(node["tracker"], where + " tracker");
+	if (not node["priority"].empty())			profile.priority		= get_integer(node["priority"], where + " priority", -1000, 1000);
+	if (not node["update_interval"].empty())	profile.update_interval	= get_integer(node["update_interval"], where + " update_interval", 1, 1000);
+	if (not node["loss_seconds"].empty())		profile.loss_seconds	= get_number(node["loss_seconds"], where + " loss_seconds", 0, 3600);
+
+	const cv::FileNode colour = node["colour"];
+	if (not colour.empty())
+	{
+		if (colour.isSeq() == false or colour.size() != 3)
+		{
+			throw std::invalid_argument(where + " colour must be [blue, green, red]");
+		}
+		profile.has_colour	= true;
+		profile.colour		= cv::Scalar(get_number(colour[0], where + " colour", 0, 255), get_number(colour[1], where + " colour", 0, 255), get_number(colour[2], where + " colour", 0, 255));
+	}
+
+	const cv::FileNode csrt = node["csrt"];
+	if (not csrt.empty())
+	{
+		if (profile.tracker_type != "csrt")
+		{
+			throw std::invalid_argument(where + " has CSRT parameters but uses a " + profile.tracker_type + " tracker");
+		}
+		check_keys(csrt,
+			{
+				"use_channel_weights", "use_segmentation", "use_hog", "use_color_names", "use_gray", "use_rgb",
+				"window_function", "kaiser_alpha", "cheb_attenuation", "padding", "template_size", "gsl_sigma",
+				"hog_orientations", "hog_clip", "num_hog_channels_used", "filter_lr", "weights_lr", "admm_iterations",
+				"number_of_scales", "scale_sigma_factor", "scale_model_max_area", "scale_lr", "scale_step",
+				"histogram_bins", "background_ratio", "histogram_lr", "psr_threshold"
+			}, where + " csrt");
+
+		// OpenCV only changes the parameters which are present
+		check_csrt_params(csrt, where);
+		profile.csrt_params.read(csrt);
+	}
+
+	// make sure the tracker can be created now rather than when the first object appears
+	create_tracker(profile);
+
+	return profile;
+}
+
+
+PipelineConfig load_pipeline_config(const std::string & filename)
+{
+	cv::FileStorage fs;
+	try
+	{
+		fs.open(filename, cv::FileStorage::READ);
+	}
+	catch (const cv::Exception & e)
+	{
+		throw std::invalid_argument("failed to parse " + filename + ": " + e.what());
+	}
+	if (fs.isOpened() == false)
+	{
+		throw std::invalid_argument("failed to open configuration file " + filename);
+	}
+
+	PipelineConfig config;
+	const cv::FileNode root = fs.root();
+	check_keys(root, {"pipeline", "profiles", "objects"}, filename);
+
+	const cv::FileNode pipeline = root["pipeline"];
+	if (not pipeline.empty())
+	{
+		check_keys(pipeline, {"tracking_size", "display_size", "object_tracking", "threads", "frames_in_flight", "backpressure", "roi", "exclusions", "duplicate_tolerance", "motion_compensation", "compact_frames", "tracker_assignment", "tile_size", "capture_backend"}, "pipeline");
+		if (not pipeline["tracking_size"].empty())			config.tracking_size			= get_size(pipeline["tracking_size"], "pipeline tracking_size");
+		if (not pipeline["display_size"].empty())			config.display_size				= get_size(pipeline["display_size"], "pipeline display_size");
+		if (not pipeline["object_tracking"].empty())		config.enable_object_tracking	= get_number(pipeline["object_tracking"], "pipeline object_tracking", 0, 1) != 0.0;
+		if (not pipeline["threads"].empty())				config.threads					= get_integer(pipeline["threads"], "pipeline threads", 0, 4096);
+		if (not pipeline["frames_in_flight"].empty())		config.frames_in_flight			= get_integer(pipeline["frames_in_flight"], "pipeline frames_in_flight", 1, 1000);
+		if (not pipeline["backpressure"].empty())			config.backpressure				= to_backpressure(get_string(pipeline["backpressure"], "pipeline backpressure"));
+		if (not pipeline["duplicate_tolerance"].empty())	config.duplicate_tolerance		= get_integer(pipeline["duplicate_tolerance"], "pipeline duplicate_tolerance", -1, 255);
+		if (not pipeline["motion_compensation"].empty())	config.motion_compensation		= get_number(pipeline["motion_compensation"], "pipeline motion_compensation", 0, 1) != 0.0;
+		if (not pipeline["compact_frames"].empty())			config.compact_frames			= get_number(pipeline["compact_frames"], "pipeline compact_frames", 0, 1) != 0.0;
+		if (not pipeline["tracker_assignment"].empty())		config.tracker_assignment		= to_tracker_assignment(get_string(pipeline["tracker_assignment"], "pipeline tracker_assignment"));
+		if (not pipeline["tile_size"].empty())				config.tile_size				= get_integer(pipeline["tile_size"], "pipeline tile_size", 16, 16384);
+		if (not pipeline["capture_backend"].empty())		config.capture_backend			= get_string(pipeline["capture_backend"], "pipeline capture_backend");
+
+		if (config.capture_backend != "auto")
+		{
+			to_capture_backend(config.capture_backend);
+		}
+
+		if (config.tracking_size.area() == 0)
+		{
+			throw std::invalid_argument("pipeline tracking_size cannot be empty");
+		}
+
+		if (not pipeline["roi"].empty())
+		{
+			config.region.roi = get_polygon(pipeline["roi"], "pipeline roi");
+		}
+		const cv::FileNode exclusions = pipeline["exclusions"];
+		if (not exclusions.empty())
+		{
+			if (exclusions.isSeq() == false)
+			{
+				throw std::invalid_argument("pipeline exclusions must be a list of polygons");
+			}
+			for (const auto & polygon : exclusions)
+			{
+				config.region.exclusions.push_back(get_polygon(polygon, "pipeline exclusions"));
+			}
+		}
+		config.region.validate();
+	}
+
+	const cv::FileNode profiles = root["profiles"];
+	if (not profiles.empty())
+	{
+		if (profiles.isMap() == false)
+		{
+			throw std::invalid_argument("profiles must be a map of profile names to settings");
+		}
+		for (const auto & name : profiles.keys())
+		{
+			config.profiles[name] = get_profile(profiles[name], name);
+		}
+	}
+
+	const cv::FileNode objects = root["objects"];
+	if (not objects.empty())
+	{
+		if (objects.isMap() == false)
+		{
+			throw std::invalid_argument("objects must be a map of object names to profile names");
+		}
+		for (const auto & name : objects.keys())
+		{
+			config.object_profiles[name] = get_string(objects[name], "object \"" + name + "\"");
+			if (profiles.empty() or profiles[config.object_profiles[name]].empty())
+			{
+				throw std::invalid_argument("object \"" + name + "\" uses an unknown profile \"" + config.object_profiles[name] + "\"");
+			}
+		}
+	}
+
+	return config;
+}
+
+
+void show_pipeline_config(const PipelineConfig & config)
+{
+	std::cout
+		<< "-> configuration: tracking at " << config.tracking_size.width << " x " << config.tracking_size.height
+		<< ", displaying at " << (config.display_size.area() ? std::to_string(config.display_size.width) + " x " + std::to_string(config.display_size.height) : "the same size")
+		<< ", " << (config.threads ? std::to_string(config.threads) : "automatic") << " worker threads"
+		<< ", " << config.frames_in_flight << " frames in flight"
+		<< ", backpressure " << to_string(config.backpressure)
+		<< (config.duplicate_tolerance < 0 ? ", duplicate frames are tracked" : ", duplicate frames skipped within " + std::to_string(config.duplicate_tolerance))
+		<< (config.enable_object_tracking ? "" : ", object tracking disabled")
+		<< (config.motion_compensation ? ", camera motion compensated" : "")
+		<< (config.compact_frames ? ", compact YUV frames" : "")
+		<< (config.tracker_assignment == TrackerAssignment::tiles ? ", trackers grouped in tiles of " + std::to_string(config.tile_size) + " pixels" : "")
+		<< (config.capture_backend == "any" ? "" : ", capture backend " + config.capture_backend)
+		<< (config.region.roi.empty() ? "" : ", ROI with " + std::to_string(config.region.roi.size()) + " corners")
+		<< (config.region.exclusions.empty() ? "" : ", " + std::to_string(config.region.exclusions.size()) + " exclusion areas")
+		<< std::endl;
+
+	for (const auto & [name, profile] : config.profiles)
+	{
+		size_t objects = 0;
+		for (const auto & object : config.object_profiles)
+		{
+			objects += (object.second == name ? 1 : 0);
+		}
+		std::cout
+			<< "-> profile \"" << name << "\": " << profile.tracker_type
+			<< ", priority " << profile.priority
+			<< ", update every " << profile.update_interval << " frame" << (profile.update_interval == 1 ? "" : "s")
+			<< ", lost after " << profile.loss_seconds << " seconds"
+			<< (name == "default" ? ", used by all other objects" : ", used by " + std::to_string(objects) + " objects")
+			<< std::endl;
+	}
+
+	return;
+}
@@ -0,0 +1,54 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "capture_backend.hpp"
+#include "region.hpp"
+#include "tracking_session.hpp"
+
+
+/// What the display does when it falls behind the video.
+enum class Backpressure
+{
+	block,		///< show every frame, even if it is late; the decoder waits for free slots
+	drop_late	///< skip showing frames which are already a frame or more late, to catch up with the video
+};
+
+Backpressure to_backpressure(const std::string & name);
+std::string to_string(const Backpressure backpressure);
+
+
+/** Settings which used to be compile-time constants, loaded from a YAML or JSON file with @p cv::FileStorage so they
+ * can be tuned per deployment.  Options given on the command line after @p --config override the file.
+ */
+struct PipelineConfig
+{
+	cv::Size			tracking_size;			///< frames are resized to fit within this size before they are tracked
+	cv::Size			display_size;			///< frames are resized to fit within this size before they are shown; empty means the tracking size
+	bool				enable_object_tracking;
+	size_t				threads;				///< worker threads; zero means the thread budget decides
+	size_t				frames_in_flight;		///< frames queued between the decoder and the display
+	Backpressure		backpressure;
+	RegionOfInterest	region;					///< ROI and exclusion polygons, in normalized coordinates
+	int					duplicate_tolerance;	///< largest block difference for a frame to be a duplicate; negative disables it
+	bool				motion_compensation;	///< shift each frame by the camera motion before the trackers see it
+	bool				compact_frames;			///< queue frames as YUV 4:2:0 instead of BGR; see @ref CompactFrame
+	TrackerAssignment	tracker_assignment;		///< how the trackers are spread across the workers
+	int					tile_size;				///< in pixels, for @ref TrackerAssignment::tiles
+	std::string			capture_backend;		///< @p "any", @p "auto", or a backend name; see @ref choose_capture_backend()
+
+	std::map<std::string, TrackerProfile>	profiles;			///< by profile name; @p "default" is used for objects which aren't listed
+	std::map<std::string, std::string>		object_profiles;	///< object name to profile name
+
+	PipelineConfig();
+};
+
+
+/** Load and validate a configuration file.  Unknown keys, unknown tracker types, and out of range values are errors,
+ * so a typo doesn't silently fall back to the default.  See @p config.yaml for an example with every setting.
+ */
+PipelineConfig load_pipeline_config(const std::string & filename);
+
+/// Display the settings which will be used.
+void show_pipeline_config(const PipelineConfig & config);
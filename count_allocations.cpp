@@ -0,0 +1,71 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+/** We replace the global @p operator @p new and @p operator @p delete so allocations can be counted.  The counters
+ * are relaxed atomics, which costs next to nothing compared to the call to malloc().  This file is only linked into
+ * the executable:  a library must not replace the allocator of the program which loads it.
+ * @{
+ */
+extern std::atomic<size_t> allocation_counter;
+extern std::atomic<size_t> deallocation_counter;
+
+
+void * operator new(std::size_t size)
+{
+	allocation_counter.fetch_add(1, std::memory_order_relaxed);
+	void * ptr = std::malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+
+void * operator new(std::size_t size, std::align_val_t alignment)
+{
+	allocation_counter.fetch_add(1, std::memory_order_relaxed);
+	void * ptr = nullptr;
+	if (posix_memalign(&ptr, std::max(sizeof(void*), static_cast<size_t>(alignment)), size == 0 ? 1 : size) != 0)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+
+void operator delete(void * ptr) noexcept
+{
+	if (ptr)
+	{
+		deallocation_counter.fetch_add(1, std::memory_order_relaxed);
+		std::free(ptr);
+	}
+}
+
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+
+void operator delete(void * ptr, std::align_val_t) noexcept
+{
+	operator delete(ptr);
+}
+
+
+void operator delete(void * ptr, std::size_t, std::align_val_t) noexcept
+{
+	operator delete(ptr);
+}
+/// @}
@@ -0,0 +1,210 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "cpu_dispatch.hpp"
+#include <opencv2/opencv.hpp>
+#include <cstdlib>
+#include <unistd.h>
+
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CSRT_X86_DISPATCH 1
+#define CSRT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CSRT_X86_DISPATCH 0
+#endif
+
+
+/** The body of each kernel is written once in plain C++ and force-inlined into a wrapper for each ISA.  The compiler
+ * then auto-vectorizes each copy using the instructions enabled by the wrapper's target attribute.
+ */
+static inline __attribute__((always_inline)) void saturating_add_body(uint8_t * dst, const uint8_t * src, const size_t bytes)
+{
+	for (size_t idx = 0; idx < bytes; idx ++)
+	{
+		const unsigned int v = dst[idx] + src[idx];
+		dst[idx] = (v > 255 ? 255 : v);
+	}
+}
+
+
+static inline __attribute__((always_inline)) uint8_t max_absolute_difference_body(const uint8_t * lhs, const uint8_t * rhs, const size_t bytes)
+{
+	uint8_t result = 0;
+	for (size_t idx = 0; idx < bytes; idx ++)
+	{
+		const uint8_t v = (lhs[idx] > rhs[idx] ? lhs[idx] - rhs[idx] : rhs[idx] - lhs[idx]);
+		result = (v > result ? v : result);
+	}
+
+	return result;
+}
+
+
+static void saturating_add_baseline(uint8_t * dst, const uint8_t * src, const size_t bytes)
+{
+	saturating_add_body(dst, src, bytes);
+}
+
+
+static uint8_t max_absolute_difference_baseline(const uint8_t * lhs, const uint8_t * rhs, const size_t bytes)
+{
+	return max_absolute_difference_body(lhs, rhs, bytes);
+}
+
+
+#if CSRT_X86_DISPATCH
+CSRT_TARGET("sse4.2")				static void saturating_add_sse4		(uint8_t * dst, const uint8_t * src, const size_t bytes) { saturating_add_body(dst, src, bytes); }
+CSRT_TARGET("avx2,fma,bmi2")		static void saturating_add_avx2		(uint8_t * dst, const uint8_t * src, const size_t bytes) { saturating_add_body(dst, src, bytes); }
+CSRT_TARGET("avx512f,avx512bw,avx512vl")	static void saturating_add_avx512	(uint8_t * dst, const uint8_t * src, const size_t bytes) { saturating_add_body(dst, src, bytes); }
+
+CSRT_TARGET("sse4.2")				static uint8_t max_absolute_difference_sse4		(const uint8_t * lhs, const uint8_t * rhs, const size_t bytes) { return max_absolute_difference_body(lhs, rhs, bytes); }
+CSRT_TARGET("avx2,fma,bmi2")		static uint8_t max_absolute_difference_avx2		(const uint8_t * lhs, const uint8_t * rhs, const size_t bytes) { return max_absolute_difference_body(lhs, rhs, bytes); }
+CSRT_TARGET("avx512f,avx512bw,avx512vl")	static uint8_t max_absolute_difference_avx512	(const uint8_t * lhs, const uint8_t * rhs, const size_t bytes) { return max_absolute_difference_body(lhs, rhs, bytes); }
+#endif
+
+
+static const CpuKernels kernels_by_level[] =
+{
+#if CSRT_X86_DISPATCH
+	{ saturating_add_baseline	, max_absolute_difference_baseline	},
+	{ saturating_add_sse4		, max_absolute_difference_sse4		},
+	{ saturating_add_avx2		, max_absolute_difference_avx2		},
+	{ saturating_add_avx512		, max_absolute_difference_avx512	},
+#else
+	{ saturating_add_baseline	, max_absolute_difference_baseline	},
+	{ saturating_add_baseline	, max_absolute_difference_baseline	},
+	{ saturating_add_baseline	, max_absolute_difference_baseline	},
+	{ saturating_add_baseline	, max_absolute_difference_baseline	},
+#endif
+};
+
+
+/// Selected at startup by initialize_cpu_dispatch().  Until then, only the portable kernels are used.
+static CpuLevel selected_level = CpuLevel::baseline;
+
+
+/// OpenCV's names for the dispatched features above each level, used to build @p OPENCV_CPU_DISABLE.
+static std::string opencv_features_above(const CpuLevel level)
+{
+	const std::string avx512	= "AVX_512F,AVX512_COMMON,AVX512_SKX,AVX512_KNL,AVX512_KNM,AVX512_CNL,AVX512_CLX,AVX512_ICL";
+	const std::string avx2		= "AVX,FP16,AVX2,FMA3," + avx512;
+	const std::string sse4		= "SSE4_1,SSE4_2,POPCNT," + avx2;
+
+	switch (level)
+	{
+		case CpuLevel::baseline:	return sse4;
+		case CpuLevel::sse4:		return avx2;
+		case CpuLevel::avx2:		return avx512;
+		case CpuLevel::avx512:		break;
+	}
+
+	return "";
+}
+
+
+std::string to_string(const CpuLevel level)
+{
+	switch (level)
+	{
+		case CpuLevel::baseline:	return "baseline";
+		case CpuLevel::sse4:		return "sse4";
+		case CpuLevel::avx2:		return "avx2";
+		case CpuLevel::avx512:		return "avx512";
+	}
+
+	return "unknown";
+}
+
+
+CpuLevel detect_cpu_level()
+{
+#if CSRT_X86_DISPATCH
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512bw") and __builtin_cpu_supports("avx512vl"))
+	{
+		return CpuLevel::avx512;
+	}
+	if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma") and __builtin_cpu_supports("bmi2"))
+	{
+		return CpuLevel::avx2;
+	}
+	if (__builtin_cpu_supports("sse4.2"))
+	{
+		return CpuLevel::sse4;
+	}
+#endif
+
+	return CpuLevel::baseline;
+}
+
+
+CpuLevel active_cpu_level()
+{
+	return selected_level;
+}
+
+
+const CpuKernels & cpu_kernels()
+{
+	return kernels_by_level[static_cast<int>(selected_level)];
+}
+
+
+void initialize_cpu_dispatch(char * argv[])
+{
+	const CpuLevel detected = detect_cpu_level();
+	selected_level = detected;
+	std::string reason = "detected";
+
+	const char * env = std::getenv("CSRT_CPU_LEVEL");
+	if (env and *env)
+	{
+		const std::string requested = env;
+		CpuLevel forced = CpuLevel::baseline;
+		if		(requested == "baseline")	forced = CpuLevel::baseline;
+		else if	(requested == "sse4")		forced = CpuLevel::sse4;
+		else if	(requested == "avx2")		forced = CpuLevel::avx2;
+		else if	(requested == "avx512")		forced = CpuLevel::avx512;
+		else
+		{
+			throw std::invalid_argument("CSRT_CPU_LEVEL must be baseline, sse4, avx2, or avx512 (not \"" + requested + "\")");
+		}
+
+		if (forced > detected)
+		{
+			std::cout << "-> CSRT_CPU_LEVEL=" << requested << " is not supported by this CPU, using " << to_string(detected) << std::endl;
+		}
+		else
+		{
+			selected_level = forced;
+			reason = "forced by CSRT_CPU_LEVEL";
+		}
+
+		// OpenCV reads OPENCV_CPU_DISABLE once when it is loaded, so we need to restart ourself to restrict OpenCV as well
+		const std::string disable = opencv_features_above(selected_level);
+		if (disable.empty() == false and std::getenv("OPENCV_CPU_DISABLE") == nullptr)
+		{
+			setenv("OPENCV_CPU_DISABLE", disable.c_str(), 1);
+			execv("/proc/self/exe", argv);
+
+			// if we get here then exec failed, but we can still run with our own kernels restricted
+			std::cout << "-> failed to restart with OPENCV_CPU_DISABLE set; only our own kernels will be restricted" << std::endl;
+		}
+
+		if (selected_level == CpuLevel::baseline)
+		{
+			// also turn off IPP and the other optional code paths within OpenCV
+			cv::setUseOptimized(false);
+		}
+	}
+
+	std::cout
+		<< "-> CPU dispatch: " << to_string(selected_level) << " kernels (" << reason << ", CPU supports " << to_string(detected) << ")" << std::endl
+		<< "-> OpenCV " << CV_VERSION << " dispatch: " << cv::getCPUFeaturesLine()
+		<< (cv::useOptimized() ? "" : " [optimizations disabled]")
+		<< std::endl;
+
+	return;
+}
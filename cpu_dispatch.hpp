@@ -0,0 +1,50 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/** The instruction set levels we know how to dispatch to.  A single binary is built with all of them, and the best one
+ * supported by the CPU is selected at startup.  The environment variable @p CSRT_CPU_LEVEL can be set to one of
+ * @p "baseline", @p "sse4", @p "avx2" or @p "avx512" to force a lower level for testing.
+ */
+enum class CpuLevel
+{
+	baseline,
+	sse4,
+	avx2,
+	avx512
+};
+
+
+/// Per-pixel kernels which exist in several ISA variants.  Use @ref cpu_kernels() to get the ones which are active.
+struct CpuKernels
+{
+	/// @p dst[i] = min(255, dst[i] + src[i]) for @p bytes bytes.
+	void (*saturating_add)(uint8_t * dst, const uint8_t * src, const size_t bytes);
+
+	/// Largest @p |lhs[i] - rhs[i]| over @p bytes bytes.
+	uint8_t (*max_absolute_difference)(const uint8_t * lhs, const uint8_t * rhs, const size_t bytes);
+};
+
+
+/** Detect the CPU, apply the @p CSRT_CPU_LEVEL override (to both our kernels and OpenCV's), and log which variants are
+ * active.  This must be called at the very top of @p main().  OpenCV only reads @p OPENCV_CPU_DISABLE when the library
+ * is loaded, so when the override needs to restrict OpenCV this call may re-execute the process with that variable set.
+ */
+void initialize_cpu_dispatch(char * argv[]);
+
+/// Highest level supported by this CPU.
+CpuLevel detect_cpu_level();
+
+/// Level which was selected by @ref initialize_cpu_dispatch().
+CpuLevel active_cpu_level();
+
+std::string to_string(const CpuLevel level);
+
+/// Get the kernels for the active CPU level.
+const CpuKernels & cpu_kernels();
@@ -0,0 +1,280 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "csrt.h"
+#include "tracking_session.hpp"
+#include <cmath>
+#include <map>
+
+
+struct csrt_context
+{
+	WorkerPool pool;
+
+	explicit csrt_context(const size_t threads) :
+		pool(threads)
+	{
+		return;
+	}
+};
+
+
+struct csrt_session
+{
+	TrackingSession	session;
+	std::string		error;
+	bool			has_pending;	///< @p true if @ref pending was pulled but didn't fit in the caller's buffer
+	FrameResults	pending;
+	std::map<uint64_t, csrt_rect>	last_rects;	///< where each object was last found, returned while it is lost; kept like the trackers until the object is removed
+
+	explicit csrt_session(WorkerPool & pool) :
+		session(pool),
+		has_pending(false)
+	{
+		return;
+	}
+};
+
+
+/// Errors which happen before there is a session to store them in.
+static thread_local std::string thread_error;
+
+
+/// Run @p f, turning any exception into a status and an error message.
+template <typename F>
+static csrt_status call(std::string & error, F f)
+{
+	try
+	{
+		error.clear();
+		return f();
+	}
+	catch (const std::invalid_argument & e)
+	{
+		error = e.what();
+		return CSRT_INVALID_ARGUMENT;
+	}
+	catch (const std::exception & e)
+	{
+		error = e.what();
+	}
+	catch (...)
+	{
+		error = "unknown exception caught";
+	}
+
+	return CSRT_FAILED;
+}
+
+
+/// Wrap the caller's pixels in a cv::Mat without copying them.
+static cv::Mat to_mat(const csrt_frame * frame)
+{
+	if (frame == nullptr or frame->data == nullptr or frame->width <= 0 or frame->height <= 0)
+	{
+		throw std::invalid_argument("frame is missing or empty");
+	}
+	if (frame->format != CSRT_PIXEL_FORMAT_BGR24)
+	{
+		throw std::invalid_argument("unsupported pixel format " + std::to_string(frame->format));
+	}
+	if (frame->stride < static_cast<size_t>(frame->width) * 3)
+	{
+		throw std::invalid_argument("stride " + std::to_string(frame->stride) + " is too small for a width of " + std::to_string(frame->width));
+	}
+
+	return cv::Mat(frame->height, frame->width, CV_8UC3, const_cast<void *>(frame->data), frame->stride);
+}
+
+
+int csrt_api_version(void)
+{
+	return CSRT_API_VERSION;
+}
+
+
+csrt_status csrt_context_create(size_t threads, csrt_context ** context)
+{
+	return call(thread_error, [&]
+		{
+			if (context == nullptr)
+			{
+				throw std::invalid_argument("context is NULL");
+			}
+			*context = new csrt_context(threads);
+			return CSRT_OK;
+		});
+}
+
+
+void csrt_context_destroy(csrt_context * context)
+{
+	delete context;
+
+	return;
+}
+
+
+csrt_status csrt_session_create(csrt_context * context, double fps, csrt_session ** session)
+{
+	return call(thread_error, [&]
+		{
+			if (context == nullptr or session == nullptr)
+			{
+				throw std::invalid_argument("context or session is NULL");
+			}
+			if (not (fps > 0.0))
+			{
+				throw std::invalid_argument("fps must be positive");
+			}
+
+			std::unique_ptr<csrt_session> s(new csrt_session(context->pool));
+			s->session.name				= "csrt";
+			s->session.verbose			= false;
+			s->session.fps_rounded		= std::max(1L, std::lround(fps));
+			s->session.frame_duration	= std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+			*session = s.release();
+			return CSRT_OK;
+		});
+}
+
+
+void csrt_session_destroy(csrt_session * session)
+{
+	delete session;
+
+	return;
+}
+
+
+csrt_status csrt_add_object(csrt_session * session, uint64_t object_id, const csrt_rect * rect, const csrt_frame * frame)
+{
+	if (session == nullptr)
+	{
+		thread_error = "session is NULL";
+		return CSRT_INVALID_ARGUMENT;
+	}
+
+	return call(session->error, [&]
+		{
+			if (rect == nullptr or rect->width <= 0.0 or rect->height <= 0.0)
+			{
+				throw std::invalid_argument("rectangle is missing or empty");
+			}
+			cv::Mat mat = to_mat(frame);
+			session->session.use_frame_size(mat.size());
+			session->session.add_tracker(std::to_string(object_id), green, cv::Rect2d(rect->x, rect->y, rect->width, rect->height), mat);
+			session->last_rects[object_id] = *rect;
+			return CSRT_OK;
+		});
+}
+
+
+csrt_status csrt_remove_object(csrt_session * session, uint64_t object_id)
+{
+	if (session == nullptr)
+	{
+		thread_error = "session is NULL";
+		return CSRT_INVALID_ARGUMENT;
+	}
+
+	return call(session->error, [&]
+		{
+			session->session.remove_tracker(std::to_string(object_id));
+			session->last_rects.erase(object_id);
+			return CSRT_OK;
+		});
+}
+
+
+csrt_status csrt_push_frame(csrt_session * session, const csrt_frame * frame, uint64_t * frame_index)
+{
+	if (session == nullptr)
+	{
+		thread_error = "session is NULL";
+		return CSRT_INVALID_ARGUMENT;
+	}
+
+	return call(session->error, [&]
+		{
+			const cv::Mat mat = to_mat(frame);
+			session->session.use_frame_size(mat.size());
+			const size_t index = session->session.push_frame(mat);
+			if (frame_index)
+			{
+				*frame_index = index;
+			}
+			return CSRT_OK;
+		});
+}
+
+
+csrt_status csrt_pull_results(csrt_session * session, int wait, uint64_t * frame_index, csrt_track * tracks, size_t capacity, size_t * count)
+{
+	if (session == nullptr)
+	{
+		thread_error = "session is NULL";
+		return CSRT_INVALID_ARGUMENT;
+	}
+
+	return call(session->error, [&]
+		{
+			if (count == nullptr or (tracks == nullptr and capacity > 0))
+			{
+				throw std::invalid_argument("count or tracks is NULL");
+			}
+
+			if (session->has_pending == false)
+			{
+				if (session->session.pull_results(session->pending, wait != 0) == false)
+				{
+					return session->session.frames_in_flight() == 0 ? CSRT_END : CSRT_NOT_READY;
+				}
+				// we won't need the pixels again, and the caller may reuse them once the results are returned
+				session->pending.frame.release();
+				session->has_pending = true;
+			}
+
+			const FrameResults & results = session->pending;
+			*count = results.tracks.size();
+			if (frame_index)
+			{
+				*frame_index = results.frame_index;
+			}
+			if (capacity < results.tracks.size())
+			{
+				return CSRT_BUFFER_TOO_SMALL;
+			}
+
+			for (size_t idx = 0; idx < results.tracks.size(); idx ++)
+			{
+				const TrackResult & track = results.tracks[idx];
+				const uint64_t object_id = std::stoull(track.name);
+				if (track.found)
+				{
+					session->last_rects[object_id] = {track.rect.x, track.rect.y, track.rect.width, track.rect.height};
+				}
+				// the tracker forgets the rectangle when the object is lost, so give back the last one which was found
+				tracks[idx].object_id	= object_id;
+				tracks[idx].rect		= session->last_rects[object_id];
+				tracks[idx].found		= track.found ? 1 : 0;
+				tracks[idx].valid		= track.valid ? 1 : 0;
+			}
+			session->has_pending = false;
+
+			return CSRT_OK;
+		});
+}
+
+
+size_t csrt_frames_in_flight(const csrt_session * session)
+{
+	return session ? session->session.frames_in_flight() + (session->has_pending ? 1 : 0) : 0;
+}
+
+
+const char * csrt_last_error(const csrt_session * session)
+{
+	return session ? session->error.c_str() : thread_error.c_str();
+}
@@ -0,0 +1,128 @@
+/* CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+ * MIT license applies.  See "license.txt" for details.
+ */
+
+#pragma once
+
+/** @file
+ * C API to the tracking library, so it can be linked directly into other programs instead of running @p CSRTExample.
+ *
+ * A context owns the worker threads.  Any number of sessions (one per video) can share a context.  The caller decodes
+ * the video, pushes each frame by pointer, and pulls the tracks of each frame in the same order.  Frames are not
+ * copied:  the pixels passed to @ref csrt_push_frame() must stay valid and unchanged until the results for that frame
+ * have been pulled.  The first frame given to a session sets the size of its frames; a frame of any other size is
+ * rejected with @ref CSRT_INVALID_ARGUMENT.
+ *
+ * Every function returns a @ref csrt_status.  When a function fails, @ref csrt_last_error() describes why.  The
+ * functions of one session must not be called concurrently, but different sessions may be used from different threads.
+ *
+ * Only append to this file:  existing functions, structures and values must not change, so programs built against an
+ * older version keep working.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define CSRT_API __attribute__((visibility("default")))
+#else
+#define CSRT_API
+#endif
+
+/// Incremented each time something is added to this API.
+#define CSRT_API_VERSION 1
+
+typedef enum csrt_status
+{
+	CSRT_OK					= 0,
+	CSRT_NOT_READY			= 1,	///< no results yet; try again later or wait
+	CSRT_END				= 2,	///< no frames are in flight
+	CSRT_BUFFER_TOO_SMALL	= 3,	///< the track buffer needs more entries; the results are kept for the next call
+	CSRT_INVALID_ARGUMENT	= -1,
+	CSRT_FAILED				= -2
+} csrt_status;
+
+typedef enum csrt_pixel_format
+{
+	CSRT_PIXEL_FORMAT_BGR24	= 0	///< 3 bytes per pixel, blue first, which is what OpenCV uses
+} csrt_pixel_format;
+
+/// Pixels owned by the caller.  Rows may be padded:  @p stride is the number of bytes from one row to the next.
+typedef struct csrt_frame
+{
+	const void *		data;
+	int32_t				width;
+	int32_t				height;
+	size_t				stride;
+	csrt_pixel_format	format;
+} csrt_frame;
+
+typedef struct csrt_rect
+{
+	double x;
+	double y;
+	double width;
+	double height;
+} csrt_rect;
+
+/// Where one object was found in one frame.
+typedef struct csrt_track
+{
+	uint64_t	object_id;	///< ID given to @ref csrt_add_object()
+	csrt_rect	rect;		///< most recent position; not updated when the object wasn't found in this frame
+	int32_t		found;		///< non-zero if the object was found in this frame
+	int32_t		valid;		///< zero once the object hasn't been seen for 3 seconds and is no longer tracked
+} csrt_track;
+
+typedef struct csrt_context csrt_context;
+typedef struct csrt_session csrt_session;
+
+/// Returns @ref CSRT_API_VERSION of the library, which may be newer than the header the caller was built with.
+CSRT_API int csrt_api_version(void);
+
+/// Start @p threads worker threads.  Zero means one per CPU core.
+CSRT_API csrt_status csrt_context_create(size_t threads, csrt_context ** context);
+
+/// Destroy a context once all of its sessions have been destroyed.
+CSRT_API void csrt_context_destroy(csrt_context * context);
+
+/// Create a session for one video.  @p fps is used to decide when a lost object is given up on.
+CSRT_API csrt_status csrt_session_create(csrt_context * context, double fps, csrt_session ** session);
+
+/// Waits for any frames which are still being tracked.
+CSRT_API void csrt_session_destroy(csrt_session * session);
+
+/** Start tracking an object, found at @p rect in @p frame.  The frame is only used during this call, and must be the
+ * next frame pushed:  the object is tracked starting with that frame.  If @p object_id is already in use in this
+ * session, its tracker is replaced by a new one seeded at @p rect, which is how a drifting object is re-seeded.
+ */
+CSRT_API csrt_status csrt_add_object(csrt_session * session, uint64_t object_id, const csrt_rect * rect, const csrt_frame * frame);
+
+/// Stop tracking an object, starting with the next frame.
+CSRT_API csrt_status csrt_remove_object(csrt_session * session, uint64_t object_id);
+
+/** Queue a frame for tracking and return immediately.  @p frame_index (optional) is set to the index which will be
+ * given back with the results.  The pixels are not copied; see above.
+ */
+CSRT_API csrt_status csrt_push_frame(csrt_session * session, const csrt_frame * frame, uint64_t * frame_index);
+
+/** Get the tracks for the oldest frame which has finished tracking.  If @p wait is non-zero this blocks until they are
+ * ready, otherwise @ref CSRT_NOT_READY is returned.  Up to @p capacity tracks are written to @p tracks, and @p count
+ * is set to the number of tracks in the frame.  If @p capacity is too small, @ref CSRT_BUFFER_TOO_SMALL is returned
+ * and the same frame is returned by the next call.  Returns @ref CSRT_END if no frames are in flight.
+ */
+CSRT_API csrt_status csrt_pull_results(csrt_session * session, int wait, uint64_t * frame_index, csrt_track * tracks, size_t capacity, size_t * count);
+
+/// Number of frames which were pushed but not yet pulled.
+CSRT_API size_t csrt_frames_in_flight(const csrt_session * session);
+
+/// Description of the last error for this session, or for the calling thread if @p session is @p NULL.  Never @p NULL.
+CSRT_API const char * csrt_last_error(const csrt_session * session);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "duplicate_frames.hpp"
+#include "cpu_dispatch.hpp"
+
+
+/// Width of the thumbnails which are compared.  At 1024 pixels wide, each thumbnail pixel is a 16x16 block.
+static const int thumbnail_width = 64;
+
+
+DuplicateFrameDetector::DuplicateFrameDetector(const int t) :
+	tolerance(t),
+	frames(0),
+	duplicates(0)
+{
+	return;
+}
+
+
+bool DuplicateFrameDetector::is_duplicate(const cv::Mat & mat)
+{
+	if (tolerance < 0 or mat.empty() or mat.depth() != CV_8U)
+	{
+		return false;
+	}
+
+	frames ++;
+
+	const int thumbnail_height = std::max(1, static_cast<int>(std::round(static_cast<double>(thumbnail_width) * mat.rows / mat.cols)));
+	cv::resize(mat, thumbnail, cv::Size(thumbnail_width, thumbnail_height), 0, 0, cv::INTER_AREA);
+
+	if (reference.size() == thumbnail.size() and reference.type() == thumbnail.type())
+	{
+		const size_t bytes = thumbnail.total() * thumbnail.elemSize();
+		if (cpu_kernels().max_absolute_difference(reference.ptr(), thumbnail.ptr(), bytes) <= tolerance)
+		{
+			duplicates ++;
+			return true;
+		}
+	}
+
+	// this frame will be tracked, so it becomes the one which the following frames are compared against
+	std::swap(reference, thumbnail);
+
+	return false;
+}
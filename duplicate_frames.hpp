@@ -0,0 +1,36 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+
+/** Recognize frames which repeat the previous one, such as those inserted by a 30 to 60 FPS pull-up or sent by a
+ * stalled camera, so the trackers don't have to be updated again on the same image.  Each frame is shrunk to a small
+ * thumbnail where every pixel is the average of a block of the frame, and compared with the thumbnail of the last frame
+ * which was not a duplicate.  Comparing the largest difference of any block rather than the sum over the whole frame
+ * means a small object such as a ball which moves across a still background is never mistaken for a repeated frame,
+ * while the averaging hides the noise of the video compression.
+ */
+class DuplicateFrameDetector
+{
+	public:
+
+		/// @p tolerance is the largest difference (0-255) in any block which still counts as a duplicate.
+		DuplicateFrameDetector(const int tolerance = 2);
+
+		/** Returns @p true if @p mat is a duplicate of the last frame which was not.  The detector is not thread-safe;
+		 * frames must be given to it in order from a single thread.
+		 */
+		bool is_duplicate(const cv::Mat & mat);
+
+		int		tolerance;	///< negative to disable the detector
+		size_t	frames;		///< number of frames checked
+		size_t	duplicates;	///< number of frames which were duplicates
+
+	private:
+
+		cv::Mat reference;	///< thumbnail of the last frame which was not a duplicate
+		cv::Mat thumbnail;	///< thumbnail of the current frame; kept to avoid an allocation for each frame
+};
@@ -0,0 +1,345 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "frame_arena.hpp"
+#include "huge_pages.hpp"
+#include "numa.hpp"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <mutex>
+
+
+/// Size of each chunk of arena memory.  Allocations larger than a quarter of this go straight to the heap.
+static const size_t chunk_size		= 4 * 1024 * 1024;
+static const size_t chunk_alignment	= 64;
+
+/// Chunks which were pinned and later released are kept here for any thread to reuse, up to this limit.
+static const size_t max_pooled_chunks = 32;
+
+
+/** One contiguous block of arena memory.  The owning arena holds one reference while the chunk is in its lists, and each
+ * Mat allocated from the chunk holds another.  Whoever drops the last reference gives the chunk back to the pool.
+ */
+struct ArenaChunk
+{
+	uint8_t *			memory;
+	bool				huge;		///< memory came from huge_page_allocate() instead of the heap
+	int					numa_node;	///< node preferred by the thread which created the chunk (see numa.hpp)
+	size_t				offset;
+	std::atomic<size_t>	references;
+};
+
+
+static std::atomic<bool>	installed			(false);
+static std::atomic<bool>	arena_enabled		(false);
+static std::atomic<size_t>	updates_counter		(0);
+static std::atomic<size_t>	arena_allocations	(0);
+static std::atomic<size_t>	arena_bytes			(0);
+static std::atomic<size_t>	heap_allocations	(0);
+static std::atomic<size_t>	new_chunks			(0);
+static std::atomic<size_t>	pinned_chunks		(0);
+
+/// Chunks which can be reused by any thread.
+struct ChunkPool
+{
+	std::mutex mutex;
+	std::vector<ArenaChunk *> chunks;
+};
+
+
+/// The pool is deliberately never destroyed, since Mats owned by globals may still be released during static destruction.
+static ChunkPool & chunk_pool()
+{
+	static ChunkPool * pool = new ChunkPool;
+	return *pool;
+}
+
+
+static ArenaChunk * get_chunk()
+{
+	{
+		ChunkPool & pool = chunk_pool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		// only reuse chunks from this thread's NUMA node so the tracker temporaries stay node-local
+		const int numa_node = get_thread_numa_node();
+		for (auto iter = pool.chunks.rbegin(); iter != pool.chunks.rend(); iter ++)
+		{
+			ArenaChunk * chunk = *iter;
+			if (chunk->numa_node == numa_node)
+			{
+				pool.chunks.erase(std::next(iter).base());
+				chunk->offset = 0;
+				chunk->references = 1;
+				return chunk;
+			}
+		}
+	}
+
+	ArenaChunk * chunk = new ArenaChunk;
+	chunk->huge = (huge_page_mode() != HugePageMode::off);
+	chunk->numa_node = get_thread_numa_node();
+	chunk->memory = static_cast<uint8_t *>(chunk->huge ? huge_page_allocate(chunk_size) : cv::fastMalloc(chunk_size));
+	chunk->offset = 0;
+	chunk->references = 1;
+	new_chunks.fetch_add(1, std::memory_order_relaxed);
+
+	return chunk;
+}
+
+
+/// Drop one reference, and recycle the chunk if it was the last one.  Can be called from any thread.
+static void release_chunk(ArenaChunk * chunk)
+{
+	if (chunk->references.fetch_sub(1) == 1)
+	{
+		ChunkPool & pool = chunk_pool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		if (pool.chunks.size() < max_pooled_chunks)
+		{
+			pool.chunks.push_back(chunk);
+			return;
+		}
+
+		if (chunk->huge)
+		{
+			huge_page_free(chunk->memory, chunk_size);
+		}
+		else
+		{
+			cv::fastFree(chunk->memory);
+		}
+		delete chunk;
+	}
+
+	return;
+}
+
+
+/// The per-thread arena.  Only the owning thread allocates from it or resets it.
+class ThreadArena
+{
+	public:
+
+		~ThreadArena()
+		{
+			for (auto chunk : used)
+			{
+				release_chunk(chunk);
+			}
+			for (auto chunk : spare)
+			{
+				release_chunk(chunk);
+			}
+		}
+
+		uint8_t * allocate(const size_t bytes, ArenaChunk *& chunk)
+		{
+			if (used.empty() or used.back()->offset + bytes > chunk_size)
+			{
+				if (spare.empty())
+				{
+					used.push_back(get_chunk());
+				}
+				else
+				{
+					used.push_back(spare.back());
+					spare.pop_back();
+				}
+			}
+
+			chunk = used.back();
+			uint8_t * ptr = chunk->memory + chunk->offset;
+			chunk->offset = (chunk->offset + bytes + chunk_alignment - 1) & ~(chunk_alignment - 1);
+			chunk->references ++;
+
+			return ptr;
+		}
+
+		/// Rewind every chunk which no longer has live Mats, and set aside the ones which are still pinned.
+		void reset()
+		{
+			for (auto chunk : used)
+			{
+				if (chunk->references.load() == 1)
+				{
+					chunk->offset = 0;
+					spare.push_back(chunk);
+				}
+				else
+				{
+					pinned_chunks.fetch_add(1, std::memory_order_relaxed);
+					release_chunk(chunk);
+				}
+			}
+			used.clear();
+
+			return;
+		}
+
+		size_t depth = 0;
+
+	private:
+
+		std::vector<ArenaChunk *> used;		///< chunks handed out during this scope; the last one is the current chunk
+		std::vector<ArenaChunk *> spare;	///< chunks which were reset and can be reused by the next scope
+};
+
+
+static thread_local ThreadArena thread_arena;
+
+
+/** Serves Mats from the calling thread's arena while a @ref FrameArenaScope is active.  Large Mats such as entire frames
+ * come from the huge page pool when huge pages are enabled.  Everything else goes to OpenCV's standard allocator.
+ */
+class ArenaMatAllocator : public cv::MatAllocator
+{
+	public:
+
+		cv::UMatData * allocate(int dims, const int * sizes, int type, void * data0, size_t * step, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override
+		{
+			const bool use_huge_pages = (huge_page_mode() != HugePageMode::off);
+
+			if (data0 == nullptr and (thread_arena.depth > 0 or use_huge_pages))
+			{
+				size_t total = CV_ELEM_SIZE(type);
+				for (int idx = dims - 1; idx >= 0; idx --)
+				{
+					if (step)
+					{
+						step[idx] = total;
+					}
+					total *= sizes[idx];
+				}
+
+				if (use_huge_pages and total >= huge_page_threshold)
+				{
+					uint8_t * ptr = static_cast<uint8_t *>(huge_page_allocate(total));
+
+					cv::UMatData * u = new cv::UMatData(this);
+					u->data		= ptr;
+					u->origdata	= ptr;
+					u->size		= total;
+					u->userdata	= nullptr;	// not an arena chunk
+
+					heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+					return u;
+				}
+
+				if (thread_arena.depth > 0 and total <= chunk_size / 4)
+				{
+					ArenaChunk * chunk = nullptr;
+					uint8_t * ptr = thread_arena.allocate(total, chunk);
+
+					cv::UMatData * u = new cv::UMatData(this);
+					u->data		= ptr;
+					u->origdata	= ptr;
+					u->size		= total;
+					u->userdata	= chunk;
+
+					arena_allocations.fetch_add(1, std::memory_order_relaxed);
+					arena_bytes.fetch_add(total, std::memory_order_relaxed);
+
+					return u;
+				}
+			}
+
+			// the standard allocator sets itself as the "current allocator", so these Mats never come back to us
+			heap_allocations.fetch_add(1, std::memory_order_relaxed);
+			return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data0, step, flags, usage);
+		}
+
+		bool allocate(cv::UMatData * u, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override
+		{
+			return u != nullptr;
+		}
+
+		void deallocate(cv::UMatData * u) const override
+		{
+			if (u)
+			{
+				if (u->userdata)
+				{
+					release_chunk(static_cast<ArenaChunk *>(u->userdata));
+				}
+				else
+				{
+					huge_page_free(u->origdata, u->size);
+				}
+				u->origdata = nullptr;
+				delete u;
+			}
+
+			return;
+		}
+};
+
+
+void install_mat_allocator()
+{
+	if (installed.exchange(true) == false)
+	{
+		// never deleted, since Mats owned by globals are released during static destruction and still need the allocator
+		cv::Mat::setDefaultAllocator(new ArenaMatAllocator);
+	}
+
+	return;
+}
+
+
+void install_frame_arena()
+{
+	install_mat_allocator();
+	arena_enabled = true;
+
+	return;
+}
+
+
+bool frame_arena_installed()
+{
+	return arena_enabled;
+}
+
+
+ArenaStats get_arena_stats()
+{
+	ArenaStats stats;
+	stats.updates			= updates_counter	.load(std::memory_order_relaxed);
+	stats.arena_allocations	= arena_allocations	.load(std::memory_order_relaxed);
+	stats.arena_bytes		= arena_bytes		.load(std::memory_order_relaxed);
+	stats.heap_allocations	= heap_allocations	.load(std::memory_order_relaxed);
+	stats.new_chunks		= new_chunks		.load(std::memory_order_relaxed);
+	stats.pinned_chunks		= pinned_chunks		.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+
+FrameArenaScope::FrameArenaScope() :
+	active(arena_enabled)
+{
+	if (active)
+	{
+		thread_arena.depth ++;
+	}
+
+	return;
+}
+
+
+FrameArenaScope::~FrameArenaScope()
+{
+	if (active)
+	{
+		thread_arena.depth --;
+		if (thread_arena.depth == 0)
+		{
+			thread_arena.reset();
+			updates_counter.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	return;
+}
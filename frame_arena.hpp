@@ -0,0 +1,57 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <cstddef>
+
+
+/** Counters for the arena.  Only Mats allocated through OpenCV's default allocator are counted, and only
+ * once @ref install_frame_arena() has been called.
+ */
+struct ArenaStats
+{
+	size_t updates;				///< outermost @ref FrameArenaScope objects which have completed, which is one per tracker update
+	size_t arena_allocations;	///< Mats served from an arena with a simple pointer bump
+	size_t arena_bytes;			///< bytes served from an arena
+	size_t heap_allocations;	///< Mats which had to go to the heap or the huge page pool (no active arena, too large, or user data)
+	size_t new_chunks;			///< calls to malloc() made to grow an arena; this should be zero in the steady state
+	size_t pinned_chunks;		///< chunks which could not be reset because a Mat allocated from them was still alive
+};
+
+
+/** Install our allocator as OpenCV's default @p cv::MatAllocator.  On its own this only routes large Mats to the huge
+ * page pool when that is enabled (see huge_pages.hpp); everything else still comes from OpenCV's standard allocator.
+ */
+void install_mat_allocator();
+
+/// Install the allocator and enable the arena.  Until this is called, @ref FrameArenaScope does nothing.
+void install_frame_arena();
+
+/// Returns @p true if @ref install_frame_arena() has been called.
+bool frame_arena_installed();
+
+/// Get a snapshot of the arena counters, summed across all threads.
+ArenaStats get_arena_stats();
+
+
+/** While one of these exists, any @p cv::Mat allocated on the calling thread comes from that thread's bump arena instead
+ * of the heap.  When the outermost scope ends, the arena is rewound so the next scope reuses the same memory.  The
+ * trackers open one around each update, since a worker can steal another frame's tasks between two of its updates.  Mats which
+ * are still alive at that point (such as a tracker model which was replaced during the update) "pin" their chunk, which
+ * is then set aside and recycled once the last of those Mats is released.  Scopes may be nested.
+ */
+class FrameArenaScope
+{
+	public:
+
+		FrameArenaScope();
+		~FrameArenaScope();
+
+		FrameArenaScope(const FrameArenaScope &) = delete;
+		FrameArenaScope & operator=(const FrameArenaScope &) = delete;
+
+	private:
+
+		bool active;
+};
@@ -0,0 +1,134 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "frame_source.hpp"
+
+
+bool FrameSource::open(const std::string & n, const int backend)
+{
+	name = n;
+	synthetic.reset();
+	next_synthetic_frame = 0;
+	truth.clear();
+
+	const std::string prefix = "synthetic";
+	if (name.compare(0, prefix.size(), prefix) == 0)
+	{
+		cv::Size size(1920, 1080);
+		if (name.size() > prefix.size())
+		{
+			// expecting something like "synthetic:1280x720"
+			int w = 0;
+			int h = 0;
+			if (name[prefix.size()] != ':' or std::sscanf(name.c_str() + prefix.size() + 1, "%dx%d", &w, &h) != 2)
+			{
+				throw std::invalid_argument("expected synthetic input to be named \"synthetic:WIDTHxHEIGHT\", not \"" + name + "\"");
+			}
+			size = cv::Size(w, h);
+		}
+		synthetic.reset(new SyntheticVideo(size));
+
+		return true;
+	}
+
+	return capture.open(name, backend);
+}
+
+
+bool FrameSource::is_open() const
+{
+	return synthetic or capture.isOpened();
+}
+
+
+bool FrameSource::read(cv::Mat & mat)
+{
+	if (synthetic)
+	{
+		if (next_synthetic_frame >= synthetic->total_frames)
+		{
+			mat = cv::Mat();
+			truth.clear();
+			return false;
+		}
+
+		synthetic->render(next_synthetic_frame, mat, &truth);
+		next_synthetic_frame ++;
+
+		return true;
+	}
+
+	return capture.read(mat) and mat.empty() == false;
+}
+
+
+bool FrameSource::grab()
+{
+	if (synthetic)
+	{
+		truth.clear();
+		if (next_synthetic_frame >= synthetic->total_frames)
+		{
+			return false;
+		}
+
+		// nothing is drawn
+		next_synthetic_frame ++;
+
+		return true;
+	}
+
+	return capture.grab();
+}
+
+
+FrameSource & FrameSource::operator>>(cv::Mat & mat)
+{
+	read(mat);
+
+	return *this;
+}
+
+
+double FrameSource::get(const int property) const
+{
+	if (synthetic == nullptr)
+	{
+		return capture.get(property);
+	}
+
+	switch (property)
+	{
+		case cv::VideoCaptureProperties::CAP_PROP_FRAME_WIDTH:	return synthetic->size.width;
+		case cv::VideoCaptureProperties::CAP_PROP_FRAME_HEIGHT:	return synthetic->size.height;
+		case cv::VideoCaptureProperties::CAP_PROP_FRAME_COUNT:	return synthetic->total_frames;
+		case cv::VideoCaptureProperties::CAP_PROP_FPS:			return synthetic->fps;
+		case cv::VideoCaptureProperties::CAP_PROP_POS_FRAMES:	return next_synthetic_frame;
+	}
+
+	return 0.0;
+}
+
+
+bool FrameSource::set(const int property, const double value)
+{
+	if (synthetic == nullptr)
+	{
+		return capture.set(property, value);
+	}
+
+	if (property == cv::VideoCaptureProperties::CAP_PROP_POS_FRAMES and value >= 0.0)
+	{
+		next_synthetic_frame = std::round(value);
+		return true;
+	}
+
+	return false;
+}
+
+
+bool FrameSource::rewind()
+{
+	return set(cv::VideoCaptureProperties::CAP_PROP_POS_FRAMES, 0.0);
+}
@@ -0,0 +1,58 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "synthetic.hpp"
+#include <memory>
+
+
+/** Where frames come from.  This is a thin wrapper around @p cv::VideoCapture which also knows how to generate frames
+ * with @ref SyntheticVideo when the "filename" is @p "synthetic" or @p "synthetic:WIDTHxHEIGHT".  The few methods
+ * mirror the ones from @p cv::VideoCapture which this example needs.
+ */
+class FrameSource
+{
+	public:
+
+		/** Open a video file, a camera stream, or the synthetic generator.  @p backend is one of the
+		 * @p cv::VideoCaptureAPIs, and is ignored by the synthetic generator.
+		 */
+		bool open(const std::string & name, const int backend = cv::CAP_ANY);
+
+		bool is_open() const;
+
+		/// Read the next frame.  Returns @p false once the end of the video has been reached.
+		bool read(cv::Mat & mat);
+
+		/** Move past the next frame without retrieving it, so it is never converted to BGR.  Returns @p false once the
+		 * end of the video has been reached.
+		 */
+		bool grab();
+
+		/// Same as @ref read().  The mat will be empty once the end of the video has been reached.
+		FrameSource & operator>>(cv::Mat & mat);
+
+		/// Get one of the @p cv::VideoCaptureProperties, such as the width, height, FPS, or frame count.
+		double get(const int property) const;
+
+		/// Set one of the @p cv::VideoCaptureProperties.  The synthetic generator only supports @p CAP_PROP_POS_FRAMES.
+		bool set(const int property, const double value);
+
+		/// Seek back to the very first frame.
+		bool rewind();
+
+		bool is_synthetic() const { return synthetic != nullptr; }
+
+		/// Ground truth for the frame which was most recently read.  Always empty when the input is a real video.
+		const VSyntheticObjects & ground_truth() const { return truth; }
+
+		std::string name;
+		cv::VideoCapture capture;
+
+	private:
+
+		std::unique_ptr<SyntheticVideo> synthetic;
+		size_t next_synthetic_frame = 0;
+		VSyntheticObjects truth;
+};
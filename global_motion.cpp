@@ -0,0 +1,79 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "global_motion.hpp"
+
+
+/// Width of the copy of each frame where the corners are followed.
+static const int motion_width = 320;
+
+/// Fewer corners than this and the estimate isn't trusted.
+static const size_t minimum_corners = 12;
+
+
+cv::Point2d GlobalMotionEstimator::estimate(const cv::Mat & mat)
+{
+	if (mat.empty())
+	{
+		return cv::Point2d();
+	}
+
+	const double factor = static_cast<double>(mat.cols) / motion_width;
+	cv::resize(mat, small, cv::Size(motion_width, std::max(1, static_cast<int>(std::round(mat.rows / factor)))), 0, 0, cv::INTER_AREA);
+	if (small.channels() == 3)
+	{
+		cv::cvtColor(small, grey, cv::COLOR_BGR2GRAY);
+	}
+	else
+	{
+		small.copyTo(grey);
+	}
+
+	cv::Point2d motion;
+	if (previous.size() == grey.size() and corners.size() >= minimum_corners)
+	{
+		std::vector<cv::Point2f> next;
+		std::vector<uchar> status;
+		std::vector<float> error;
+		cv::calcOpticalFlowPyrLK(previous, grey, corners, next, status, error, cv::Size(15, 15), 2);
+
+		std::vector<float> dx;
+		std::vector<float> dy;
+		for (size_t idx = 0; idx < corners.size(); idx ++)
+		{
+			if (status[idx])
+			{
+				dx.push_back(next[idx].x - corners[idx].x);
+				dy.push_back(next[idx].y - corners[idx].y);
+			}
+		}
+
+		if (dx.size() >= minimum_corners)
+		{
+			std::nth_element(dx.begin(), dx.begin() + dx.size() / 2, dx.end());
+			std::nth_element(dy.begin(), dy.begin() + dy.size() / 2, dy.end());
+			const cv::Point2d median(dx[dx.size() / 2], dy[dy.size() / 2]);
+
+			// the camera only moved if most of the corners moved the same way; otherwise it's the players
+			size_t agree = 0;
+			for (size_t idx = 0; idx < corners.size(); idx ++)
+			{
+				if (status[idx] and std::abs(next[idx].x - corners[idx].x - median.x) < 1.0 and std::abs(next[idx].y - corners[idx].y - median.y) < 1.0)
+				{
+					agree ++;
+				}
+			}
+			if (2 * agree >= dx.size())
+			{
+				motion = median * factor;
+			}
+		}
+	}
+
+	// the corners are found again on every frame so they never drift off the edge of a panning frame
+	cv::goodFeaturesToTrack(grey, corners, 200, 0.01, 8.0);
+	std::swap(previous, grey);
+
+	return motion;
+}
@@ -0,0 +1,30 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+
+/** Estimate how far the whole scene moved from one frame to the next, such as when the camera pans.  Corners found in
+ * a small greyscale copy of the previous frame are followed into the current frame with pyramidal Lucas-Kanade optical
+ * flow, and the median of their displacements is the camera motion.  Players and the ball move differently than the
+ * background, but as long as most of the corners are on the background the median ignores them.
+ */
+class GlobalMotionEstimator
+{
+	public:
+
+		/** Returns how far the scene moved between the previous frame given to this function and @p mat, in pixels of
+		 * @p mat.  Returns zero for the first frame, or when too few corners agree on the motion.  The estimator is not
+		 * thread-safe; frames must be given to it in order from a single thread.
+		 */
+		cv::Point2d estimate(const cv::Mat & mat);
+
+	private:
+
+		cv::Mat previous;					///< small greyscale copy of the previous frame
+		std::vector<cv::Point2f> corners;	///< found in @ref previous
+		cv::Mat small;						///< kept to avoid allocations for each frame
+		cv::Mat grey;
+};
@@ -0,0 +1,205 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "huge_pages.hpp"
+#include "frame_arena.hpp"
+#include "numa.hpp"
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+
+
+/// Size of a "normal" x86-64 huge page.  Mappings are rounded up to this size.
+static const size_t huge_page_size = 2 * 1024 * 1024;
+
+/// Released mappings are kept for reuse until the pool holds this many bytes.
+static const size_t max_pooled_bytes = 512 * 1024 * 1024;
+
+
+static HugePageMode mode = HugePageMode::off;
+
+static std::atomic<size_t> hugetlb_mappings	(0);
+static std::atomic<size_t> thp_mappings		(0);
+static std::atomic<size_t> fallbacks		(0);
+static std::atomic<size_t> reused			(0);
+
+
+/** Released mappings, indexed by their rounded-up size and the NUMA node of the thread which mapped them.  Deliberately
+ * never destroyed (see frame_arena.cpp).
+ */
+struct MappingPool
+{
+	std::mutex mutex;
+	std::multimap<std::pair<size_t, int>, void *> mappings;
+	std::map<void *, int> numa_nodes;	///< node of every mapping we've handed out, since it may be freed from another node
+	size_t bytes = 0;
+};
+
+
+static MappingPool & mapping_pool()
+{
+	static MappingPool * pool = new MappingPool;
+	return *pool;
+}
+
+
+/// New mappings are first touched by the thread which asked for them, so they end up on that thread's node.
+static void remember_numa_node(void * ptr)
+{
+	MappingPool & pool = mapping_pool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	pool.numa_nodes[ptr] = get_thread_numa_node();
+
+	return;
+}
+
+
+static size_t round_up(const size_t bytes)
+{
+	return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+}
+
+
+void enable_huge_pages(const HugePageMode m)
+{
+	mode = m;
+	if (mode != HugePageMode::off)
+	{
+		install_mat_allocator();
+	}
+
+	return;
+}
+
+
+HugePageMode huge_page_mode()
+{
+	return mode;
+}
+
+
+HugePageMode to_huge_page_mode(const std::string & name)
+{
+	if (name == "off")		return HugePageMode::off;
+	if (name == "thp")		return HugePageMode::transparent;
+	if (name == "hugetlb")	return HugePageMode::hugetlb;
+
+	throw std::invalid_argument("huge page mode must be off, thp, or hugetlb (not \"" + name + "\")");
+}
+
+
+void * huge_page_allocate(const size_t bytes)
+{
+	const size_t size = round_up(bytes);
+
+	{
+		MappingPool & pool = mapping_pool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		auto iter = pool.mappings.find({size, get_thread_numa_node()});
+		if (iter != pool.mappings.end())
+		{
+			void * ptr = iter->second;
+			pool.mappings.erase(iter);
+			pool.bytes -= size;
+			reused.fetch_add(1, std::memory_order_relaxed);
+			return ptr;
+		}
+	}
+
+	void * ptr = MAP_FAILED;
+
+	if (mode == HugePageMode::hugetlb)
+	{
+		// this only works if the admin reserved pages, e.g.:  echo 512 | sudo tee /proc/sys/vm/nr_hugepages
+		ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (ptr != MAP_FAILED)
+		{
+			hugetlb_mappings.fetch_add(1, std::memory_order_relaxed);
+			remember_numa_node(ptr);
+			return ptr;
+		}
+	}
+
+	// mmap() only guarantees 4 KiB alignment, so map a bit more than needed and trim it to a huge page boundary
+	const size_t padded = size + huge_page_size;
+	uint8_t * raw = static_cast<uint8_t *>(mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (raw == MAP_FAILED)
+	{
+		throw std::bad_alloc();
+	}
+
+	uint8_t * aligned = reinterpret_cast<uint8_t *>(round_up(reinterpret_cast<size_t>(raw)));
+	if (aligned > raw)
+	{
+		munmap(raw, aligned - raw);
+	}
+	munmap(aligned + size, (raw + padded) - (aligned + size));
+
+	if (madvise(aligned, size, MADV_HUGEPAGE) == 0)
+	{
+		thp_mappings.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		// THP is disabled or not supported; the buffer still works with normal pages
+		fallbacks.fetch_add(1, std::memory_order_relaxed);
+	}
+	remember_numa_node(aligned);
+
+	return aligned;
+}
+
+
+void huge_page_free(void * ptr, const size_t bytes)
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	const size_t size = round_up(bytes);
+
+	{
+		MappingPool & pool = mapping_pool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		if (pool.bytes + size <= max_pooled_bytes)
+		{
+			pool.mappings.emplace(std::make_pair(size, pool.numa_nodes[ptr]), ptr);
+			pool.bytes += size;
+			return;
+		}
+		pool.numa_nodes.erase(ptr);
+	}
+
+	munmap(ptr, size);
+
+	return;
+}
+
+
+HugePageStats get_huge_page_stats()
+{
+	HugePageStats stats;
+	stats.hugetlb_mappings	= hugetlb_mappings	.load(std::memory_order_relaxed);
+	stats.thp_mappings		= thp_mappings		.load(std::memory_order_relaxed);
+	stats.fallbacks			= fallbacks			.load(std::memory_order_relaxed);
+	stats.reused			= reused			.load(std::memory_order_relaxed);
+	stats.anon_huge_bytes	= 0;
+
+	std::ifstream ifs("/proc/self/smaps_rollup");
+	std::string line;
+	while (std::getline(ifs, line))
+	{
+		if (line.compare(0, 14, "AnonHugePages:") == 0)
+		{
+			stats.anon_huge_bytes = std::stoul(line.substr(14)) * 1024;
+			break;
+		}
+	}
+
+	return stats;
+}
@@ -0,0 +1,49 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+
+/// How large buffers (frames, arena chunks) should be backed.
+enum class HugePageMode
+{
+	off,			///< normal malloc()
+	transparent,	///< mmap() + madvise(MADV_HUGEPAGE), so the kernel backs the buffer with transparent huge pages
+	hugetlb			///< mmap(MAP_HUGETLB) from the pre-reserved hugetlbfs pool, falling back to @p transparent
+};
+
+
+struct HugePageStats
+{
+	size_t hugetlb_mappings;	///< buffers mapped from the hugetlbfs pool
+	size_t thp_mappings;		///< buffers mapped with madvise(MADV_HUGEPAGE)
+	size_t fallbacks;			///< buffers which could not get huge pages and use normal pages instead
+	size_t reused;				///< buffers served from the pool of previously released mappings
+	size_t anon_huge_bytes;		///< bytes actually backed by transparent huge pages, according to the kernel
+};
+
+
+/** Back the frame buffers and the tracker arena chunks with huge pages.  This installs the Mat allocator from
+ * frame_arena.hpp, which sends every Mat of at least @ref huge_page_threshold bytes to @ref huge_page_allocate().
+ */
+void enable_huge_pages(const HugePageMode mode);
+
+HugePageMode huge_page_mode();
+
+HugePageMode to_huge_page_mode(const std::string & name);
+
+/// Mats smaller than this keep using the normal heap.
+const size_t huge_page_threshold = 1024 * 1024;
+
+/** Get a buffer of at least @p bytes from the huge page pool.  Released buffers are kept and reused for the next
+ * request of the same size, so frames of a constant size stop costing a mmap() after the first few.
+ */
+void * huge_page_allocate(const size_t bytes);
+
+/// Give back a buffer obtained from @ref huge_page_allocate().  The same @p bytes must be given.
+void huge_page_free(void * ptr, const size_t bytes);
+
+HugePageStats get_huge_page_stats();
@@ -2,182 +2,88 @@
 // MIT license applies.  See "license.txt" for details.
 
 
-#include <opencv2/opencv.hpp>
-#include <opencv2/tracking/tracker.hpp>
-
-
-typedef cv::Ptr<cv::Tracker> Tracker;	///< single object tracker (could be any OpenCV tracker, not just CSRT)
-
-struct ObjectTracker
-{
-	bool		is_valid;	///< used to detremine if this tracker should be used or skipped
-	std::string	name;		///< name we give to the tracker for debug purposes
-	cv::Scalar	colour;		///< colour we'll use to draw the output onto the mat
-	cv::Rect2d	rect;		///< last reported rectangle for this tracker
-	size_t		last_valid;	///< last frame index where this tracker reported positive results
-	Tracker		tracker;	///< CSRT tracker
-
-	/// Create an object Tracker from a rectangle and an image.
-	ObjectTracker(const std::string n, const cv::Scalar c, const cv::Rect2d r, cv::Mat & mat) :
-		is_valid(true),
-		name(n),
-		colour(c),
-		rect(r),
-		last_valid(0)
-	{
-		tracker = cv::TrackerCSRT::create();
-		tracker->init(mat, rect);
-		return;
-	}
-
-	/// Create an object Tracker from 4 normalized X,Y,W,H values instead of a cv::Rect2d.
-	ObjectTracker(const std::string n, const cv::Scalar c, const double x, const double y, const double w, const double h, cv::Mat & mat) :
-		ObjectTracker(n, c, cv::Rect2d(x * mat.cols, y * mat.rows, w * mat.cols, h * mat.rows), mat)
-	{
-		return;
-	}
-};
-
-
-typedef std::vector<ObjectTracker> VObjectTrackers;
-
-
-/** These next few variables would be in a structure or class that gets passed around.
- * For this example code I kept it simple and left them as globals.
- * @{
- */
-std::chrono::high_resolution_clock::duration frame_duration;
-cv::VideoCapture cap;
-cv::Size desired_size(1024, 768);
-bool enable_object_tracking				= true;
-std::string window_title				= "CSRT Example";
-size_t fps_rounded						= 0;
-size_t total_frames						= 0;
-/// @}
-
-/// All trackers used while the video is being processed (people, ball, etc).
-VObjectTrackers all_trackers;
-
-
-/// Remember that OpenCV uses BGR, not RGB. @{
-const cv::Scalar red	(0.0	, 0.0	, 255.0	);
-const cv::Scalar blue	(255.0	, 0.0	, 0.0	);
-const cv::Scalar green	(0.0	, 255.0	, 0.0	);
-const cv::Scalar purple	(128.0	, 0.0	, 128.0	);
-const cv::Scalar black	(0.0	, 0.0	, 0.0	);
-const cv::Scalar white	(255.0	, 255.0	, 255.0	);
+#include "affinity.hpp"
+#include "annotations.hpp"
+#include "async.hpp"
+#include "autotune.hpp"
+#include "batch.hpp"
+#include "benchmark.hpp"
+#include "config.hpp"
+#include "cpu_dispatch.hpp"
+#include "frame_arena.hpp"
+#include "frame_source.hpp"
+#include "huge_pages.hpp"
+#include "multi_stream.hpp"
+#include "numa.hpp"
+#include "shard.hpp"
+#include "soak.hpp"
+#include "thread_budget.hpp"
+#include "tracker.hpp"
+#include "tracking_session.hpp"
+
+
+/// Set to @p false to only show the video without creating any trackers.
+bool enable_object_tracking = true;
+
+/// Number of frames which are queued for tracking while the current frame is displayed.
+size_t frames_in_flight = 2;
+
+/// Frames are shown at this size; empty means they are shown at the size they were tracked.
+cv::Size display_size;
+
+/// What the display does when it falls behind.
+Backpressure backpressure = Backpressure::block;
+
+/// Seed boxes given with @p --annotations, if any.  The seeds for the first frame are read once so every mode can use them. @{
+std::unique_ptr<AnnotationReader> annotations;
+VAnnotationSeeds initial_seeds;
 /// @}
 
 
-/// Open the video, get the timing information we need, and display a few statistics.
-void initialize_video(const std::string & filename)
-{
-	cap.open(filename);
-	if (cap.isOpened() == false)
-	{
-		throw std::invalid_argument("failed to open " + filename);
-	}
-
-	const int width					= cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_WIDTH	);
-	const int height				= cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_HEIGHT	);
-	const size_t number_of_frames	= cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_COUNT	);
-	const double fps				= cap.get(cv::VideoCaptureProperties::CAP_PROP_FPS			);
-	const double fpm				= fps * 60.0;
-	const double minutes			= std::floor(number_of_frames / fpm);
-	const double seconds			= (number_of_frames - (minutes * fpm)) / fps;
-
-	fps_rounded = std::round(fps);
-	total_frames = number_of_frames;
-
-	/* 1 second = 1000 milliseconds
-	 * 1 second = 1000000 microseconds
-	 * 1 second = 1000000000 nanoseconds
-	 */
-
-	const size_t length_of_each_frame_in_nanoseconds = std::round(1000000000.0 / fps);
-	frame_duration = std::chrono::nanoseconds(length_of_each_frame_in_nanoseconds);
-
-	std::cout	<< filename << ":" << std::endl
-				<< "-> " << width << " x " << height << " @ " << fps << " FPS for "
-				<< minutes << "m" << std::fixed << std::setprecision(1) << seconds << "s"
-				<< " (" << number_of_frames << " total frames)" << std::endl
-				<< "-> each frame is " << length_of_each_frame_in_nanoseconds << " nanoseconds"
-				<< " (" << (length_of_each_frame_in_nanoseconds / 1000000.0) << " milliseconds)" << std::endl;
-
-	// figure out how much we need to zoom each frame (if they're too big to display on my screen)
-	double factor = 1.0;
-	if (width > desired_size.width or height > desired_size.height)
-	{
-		// we're going to have to resize each frame since they're larger than what we want to see
-		const double horizontal_factor	= static_cast<double>(desired_size.width)	/ static_cast<double>(width);
-		const double vertical_factor	= static_cast<double>(desired_size.height)	/ static_cast<double>(height);
-		factor							= std::max(horizontal_factor, vertical_factor);
-		desired_size = cv::Size(std::round(factor * width), std::round(factor * height));
-
-		std::cout
-			<< "-> each frame will be resized to " << desired_size.width << " x " << desired_size.height
-			<< " (zoom factor of " << factor << ")"
-			<< std::endl;
-
-	}
-	else
-	{
-		// make the desired size match the frame dimensions so we don't resize anything
-		desired_size = cv::Size(width, height);
-	}
-	window_title = window_title + " (" + std::to_string(width) + " x " + std::to_string(height) + " @ " + std::to_string(static_cast<int>(std::round(100.0 * factor))) + "%)";
-
-	return;
-}
-
-
-cv::Mat get_first_frame()
-{
-	cap.set(cv::VideoCaptureProperties::CAP_PROP_POS_FRAMES, 0.0);
-	cv::Mat mat;
-	cap >> mat;
-	cap.set(cv::VideoCaptureProperties::CAP_PROP_POS_FRAMES, 0.0);
-
-	if (mat.size() != desired_size)
-	{
-		cv::Mat tmp;
-		cv::resize(mat, tmp, desired_size);
-		mat = tmp;
-	}
-
-	return mat;
-}
-
-
 /** Initialize the trackers with the coordinates of the objects we need to track.  Normally, the coordinates would need
  * to come from something else, like the output of a neural network.  But this example code doesn't have a neural network
  * or any other place where we get the coordinates.  Instead, this function has some hard-coded coordinates which I've
- * manually calculated beforehand as objects of interest so we can demo CSRT object tracking.
+ * manually calculated beforehand as objects of interest so we can demo CSRT object tracking.  When an annotation file
+ * was given, its boxes for the first frame are used instead.
  */
-void initialize_trackers(cv::Mat & mat, const std::string & filename)
+void initialize_trackers(TrackingSession & session, cv::Mat & mat, const std::string & filename)
 {
 	/* All coordinates in this function are normalized.  This allows the code to work regardless of the
 	 * "desired size" set at the top of this file.  Once we multiply the desired by the normalized values
 	 * we'll get the coordinates which OpenCV expects us to be using.
 	 */
 
-	if (filename.find("input_3733.mp4") != std::string::npos)	// 3 kids passing the ball on soccer field.  Tracker quickly loses track of the ball but maintains track on the kids.
+	if (annotations)
 	{
-		all_trackers.emplace_back("ball", green	, 0.697435897, 0.539062500, 0.029304029, 0.052083333, mat);
-		all_trackers.emplace_back("p1"	, red	, 0.704029304, 0.207031250, 0.083516484, 0.359375000, mat);
-		all_trackers.emplace_back("p2"	, blue	, 0.032967033, 0.276041667, 0.122344322, 0.458333333, mat);
-		all_trackers.emplace_back("p3"	, purple, 0.083516484, 0.087239583, 0.069597070, 0.272135417, mat);
+		apply_seeds(session, initial_seeds, mat);
+	}
+	else if (filename.find("input_3733.mp4") != std::string::npos)	// 3 kids passing the ball on soccer field.  Tracker quickly loses track of the ball but maintains track on the kids.
+	{
+		session.add_tracker("ball", green	, 0.697435897, 0.539062500, 0.029304029, 0.052083333, mat);
+		session.add_tracker("p1"	, red	, 0.704029304, 0.207031250, 0.083516484, 0.359375000, mat);
+		session.add_tracker("p2"	, blue	, 0.032967033, 0.276041667, 0.122344322, 0.458333333, mat);
+		session.add_tracker("p3"	, purple, 0.083516484, 0.087239583, 0.069597070, 0.272135417, mat);
 	}
 	else if (filename.find("input_3750.mp4") != std::string::npos)	// 2 kids on basekeball court.  Tracker loses the one in the background.
 	{
-		all_trackers.emplace_back("p1"	, red	, 0.565567766, 0.471354167, 0.099633700, 0.528645833, mat);
-		all_trackers.emplace_back("p2"	, blue	, 0.441758242, 0.533854167, 0.070329670, 0.330729167, mat);
+		session.add_tracker("p1"	, red	, 0.565567766, 0.471354167, 0.099633700, 0.528645833, mat);
+		session.add_tracker("p2"	, blue	, 0.441758242, 0.533854167, 0.070329670, 0.330729167, mat);
+	}
+	else if (session.cap.is_synthetic())	// synthetic video knows exactly where the objects are
+	{
+		for (const auto & obj : session.cap.ground_truth())
+		{
+			if (obj.visible)
+			{
+				session.add_tracker("obj" + std::to_string(obj.id), obj.colour, session.video_to_frame(obj.rect), mat);
+			}
+		}
 	}
 
 	// go through the trackers again, this time to draw all the original rectangles onto the image
-	for (auto & ot : all_trackers)
+	for (const auto & track : session.get_tracks())
 	{
-		cv::rectangle(mat, ot.rect, ot.colour);
+		cv::rectangle(mat, track.rect, track.colour);
 	}
 
 	return;
@@ -185,107 +91,139 @@ void initialize_trackers(cv::Mat & mat, const std::string & filename)
 
 
 /// Pause on the very first frame and reset the video to the start.
-void pause_on_first_frame(cv::Mat & mat)
+void pause_on_first_frame(TrackingSession & session, cv::Mat & mat)
 {
 	std::cout << "Press any key to start.." << std::endl;
-	cv::imshow(window_title, mat);
+	cv::imshow(session.window_title, mat);
 	cv::waitKey(-1);
 }
 
 
-/// Loop through the entire video, showing every frame.  Press @p ESC to exit, any other key to pause.
-void show_video()
+/** Decode the video on the event loop's thread and queue each frame for tracking.  Waits for a free slot before each
+ * frame so no more than @ref frames_in_flight frames are ahead of the display.
+ */
+Task<> decode_frames(TrackingSession & session, EventLoop & loop, AsyncSemaphore & slots)
+{
+	try
+	{
+		VAnnotationSeeds seeds;
+		for (size_t frame_index = 0; co_await slots.acquire(); frame_index ++)
+		{
+			// don't decode on whichever thread released the slot
+			co_await loop.schedule();
+
+			cv::Mat mat;
+			if (session.read_frame(mat) == false)
+			{
+				break;
+			}
+
+			// objects which appear later in the video, or which need to be re-seeded (the first frame was done by initialize_trackers);
+			// the new trackers are initialized on this frame and are first updated when it is tracked
+			seeds.clear();
+			if (annotations and enable_object_tracking and frame_index > 0 and annotations->get_seeds(frame_index, seeds) > 0)
+			{
+				apply_seeds(session, seeds, mat);
+			}
+
+			if (session.push_frame(mat) != frame_index)
+			{
+				// the seeds are looked up by frame index, so they would start on the wrong frame
+				throw std::logic_error("frame " + std::to_string(frame_index) + " of " + session.name + " was given a different index by the tracking session");
+			}
+		}
+	}
+	catch (...)
+	{
+		session.end_input();
+		throw;
+	}
+
+	session.end_input();
+
+	co_return;
+}
+
+
+/** Draw the results of each frame on the worker which tracked it, then show it on the event loop's thread at the right
+ * time.  Press @p ESC to exit, any other key to pause.
+ */
+Task<> show_frames(TrackingSession & session, EventLoop & loop, AsyncSemaphore & slots)
 {
 	size_t frame_counter = 0;
+	size_t frames_dropped = 0;
 	auto time_to_show_next_frame = std::chrono::high_resolution_clock::now();
 	auto previous_timestamp = time_to_show_next_frame;
 	size_t previous_frame_counter = 0;
 
-	// read the video and display each frame
-	while (true)
+	try
 	{
-		cv::Mat mat;
-		cap >> mat;
-		if (mat.empty())
+		FrameResults results;
+		while (co_await session.next_results(results))
 		{
-			std::cout << "-> finished showing " << frame_counter << " frames" << std::endl;
-			break;
-		}
+			if (results.frame.empty())
+			{
+				// compact frames are only converted back to BGR here, by the one stage which shows colour
+				results.frame = results.compact.bgr();
+			}
+			cv::Mat & mat = results.frame;
 
-		// once per second we want to display some information on where we are and the FPS
-		if (frame_counter + 1 >= total_frames or frame_counter % fps_rounded == 0)
-		{
-			const auto now				= std::chrono::high_resolution_clock::now();
-			const auto duration			= now - previous_timestamp;
-			const auto recent_frames	= frame_counter - previous_frame_counter;
-			const auto fps				= 1000.0 * recent_frames / std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-			previous_frame_counter		= frame_counter;
-			previous_timestamp			= now;
-
-			std::cout
-				<< "-> processing frame # " << frame_counter << "/" << total_frames
-				<< " (" << (100.0 * (frame_counter + 1) / total_frames) << "%), "
-				<< fps << " FPS"
-				<< std::endl;
-		}
+			// once per second we want to display some information on where we are and the FPS
+			if (frame_counter + 1 >= session.total_frames or frame_counter % session.fps_rounded == 0)
+			{
+				const auto now				= std::chrono::high_resolution_clock::now();
+				const auto duration			= now - previous_timestamp;
+				const auto recent_frames	= frame_counter - previous_frame_counter;
+				const auto fps				= 1000.0 * recent_frames / std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+				previous_frame_counter		= frame_counter;
+				previous_timestamp			= now;
+
+				std::cout
+					<< "-> processing frame # " << frame_counter << "/" << session.total_frames
+					<< " (" << (100.0 * (frame_counter + 1) / session.total_frames) << "%), "
+					<< fps << " FPS"
+					<< std::endl;
+			}
 
-		if (mat.size() != desired_size)
-		{
-			cv::Mat tmp;
-			cv::resize(mat, tmp, desired_size);
-			mat = tmp;
-		}
+			if (backpressure == Backpressure::drop_late and std::chrono::high_resolution_clock::now() > time_to_show_next_frame + session.frame_duration)
+			{
+				// we're already a frame behind, so skip this one and let the next one catch up
+				frames_dropped ++;
+				time_to_show_next_frame += session.frame_duration;
+				frame_counter ++;
+				slots.release();
+				continue;
+			}
 
-		// now we update all the CSRT trackers
-		for (auto & ot : all_trackers)
-		{
-			if (ot.is_valid)
+			// draw all the recent tracker rectangles onto the image while we're still on the worker
+			for (const auto & track : results.tracks)
 			{
-				// this next call takes a *LONG* time to run!
-				const bool ok = ot.tracker->update(mat, ot.rect);
-				if (ok)
+				if (track.found)
 				{
-					ot.last_valid = frame_counter;
-				}
-				else
-				{
-					// we've lost the object...is it temporary?
-					ot.rect = cv::Rect2d(-1.0, -1.0, -1.0, -1.0);
-
-					if (frame_counter > ot.last_valid + fps_rounded * 3)
-					{
-						std::cout << "-> removing tracker for \"" << ot.name << "\" since object not seen since frame #" << ot.last_valid << "" << std::endl;
-						ot.is_valid = false;
-					}
+					cv::rectangle(mat, track.rect, track.colour);
 				}
 			}
-		}
 
-		// and finally we draw all the recent tracker rectangles onto the image
-		for (auto & ot : all_trackers)
-		{
-			if (ot.last_valid == frame_counter)
+			if (display_size.area() > 0 and mat.cols > 0 and mat.rows > 0)
 			{
-				cv::rectangle(mat, ot.rect, ot.colour);
+				const double factor = std::min(static_cast<double>(display_size.width) / mat.cols, static_cast<double>(display_size.height) / mat.rows);
+				const cv::Size size(std::round(factor * mat.cols), std::round(factor * mat.rows));
+				if (size != mat.size())
+				{
+					cv::Mat resized;
+					cv::resize(mat, resized, size, 0, 0, factor < 1.0 ? cv::INTER_AREA : cv::INTER_LINEAR);
+					mat = resized;
+				}
 			}
-		}
 
-		const auto now = std::chrono::high_resolution_clock::now();
-		auto number_of_milliseconds_to_pause = std::chrono::duration_cast<std::chrono::milliseconds>(time_to_show_next_frame - now).count();
-		if (number_of_milliseconds_to_pause <= 0)
-		{
-#if 1
+			// the window can only be used from the main thread; the decoder keeps running while we wait
+			co_await loop.sleep_until(time_to_show_next_frame);
+			cv::imshow(session.window_title, mat);
+
 			// For this example code only, we're going to wait a minimum of 1 millisecond.  This will ensure
 			// that OpenCV gets time to redraw the window.  Otherwise we might not see anything since tracking
 			// is so slow that we'll always be falling behind.
-			number_of_milliseconds_to_pause = 1;
-#endif
-		}
-
-		if (number_of_milliseconds_to_pause > 0)
-		{
-			// too early to show the next frame, we may need to briefly pause
-			auto key = cv::waitKey(number_of_milliseconds_to_pause);
+			auto key = cv::waitKey(1);
 			if (key != -1 and key != 27)
 			{
 				// user has pressed a key -- assume they're asking to pause the video
@@ -299,11 +237,47 @@ void show_video()
 			{
 				throw std::runtime_error("user requested to quit");
 			}
+
+			time_to_show_next_frame += session.frame_duration;
+			frame_counter ++;
+			slots.release();
 		}
-		cv::imshow(window_title, mat);
-		time_to_show_next_frame += frame_duration;
-		frame_counter ++;
 	}
+	catch (...)
+	{
+		// let the decoder finish so the event loop can stop
+		slots.close();
+		throw;
+	}
+
+	std::cout << "-> finished showing " << (frame_counter - frames_dropped) << " frames";
+	if (frames_dropped)
+	{
+		std::cout << " (" << frames_dropped << " dropped to keep up)";
+	}
+	std::cout << std::endl;
+
+	if (session.duplicate_frames())
+	{
+		std::cout << "-> " << session.duplicate_frames() << " of " << session.frames_checked() << " frames were duplicates and reused the previous results (" << std::fixed << std::setprecision(1) << (100.0 * session.duplicate_frames() / session.frames_checked()) << "%)" << std::endl;
+	}
+
+	co_return;
+}
+
+
+/** Loop through the entire video, showing every frame.  Decoding, tracking, drawing and display are separate coroutines
+ * so a slow stage doesn't hold up the others, yet no thread is dedicated to any one stage:  the main thread decodes
+ * and displays, and the worker pool tracks and draws.
+ */
+void show_video(TrackingSession & session)
+{
+	EventLoop loop;
+	AsyncSemaphore slots(frames_in_flight);
+
+	loop.spawn(decode_frames(session, loop, slots));
+	loop.spawn(show_frames(session, loop, slots));
+	loop.run();
 
 	return;
 }
@@ -313,23 +287,248 @@ int main(int argc, char *argv[])
 {
 	try
 	{
+		initialize_cpu_dispatch(argv);
+
 		std::string filename;
-		if (argc > 1)
+		VStreamOptions streams;
+		MultiStreamOptions multi_stream_options;
+		std::string batch_path;
+		BatchOptions batch_options;
+		ShardOptions shard_options;
+		bool sharded = false;
+		bool numa = false;
+		bool soak = false;
+		size_t benchmark_frames = 0;
+		size_t number_of_threads = 0;
+		size_t cores = 0;
+		ThreadPolicy thread_policy = ThreadPolicy::split;
+		bool compare_policies = false;
+		bool compare_assignments = false;
+		std::string annotation_filename;
+		AnnotationFormat annotation_format = AnnotationFormat::automatic;
+		AnnotationUnits annotation_units = AnnotationUnits::automatic;
+		SoakOptions soak_options;
+		bool autotune = false;
+		AutotuneOptions autotune_options;
+		CaptureBackendOptions capture_backend_options;
+
+		for (int idx = 1; idx < argc; idx ++)
 		{
-			filename = argv[1];
+			const std::string arg = argv[idx];
+
+			// get the value which follows an option such as "--soak-seconds 3600"
+			auto next_arg = [&]() -> std::string
+			{
+				if (idx + 1 >= argc)
+				{
+					throw std::invalid_argument("expected a value after " + arg);
+				}
+				idx ++;
+				return argv[idx];
+			};
+
+			if		(arg == "--soak"			)	soak = true;
+			else if	(arg == "--soak-seconds"	)	soak_options.duration_seconds	= std::stod(next_arg());
+			else if	(arg == "--soak-sample"		)	soak_options.sample_seconds		= std::stod(next_arg());
+			else if	(arg == "--soak-output"		)	soak_options.output_filename	= next_arg();
+			else if	(arg == "--soak-trackers"	)	soak_options.max_trackers		= std::stoul(next_arg());
+			else if	(arg == "--benchmark"		)	benchmark_frames				= std::stoul(next_arg());
+			else if	(arg == "--arena"			)	install_frame_arena();
+			else if	(arg == "--hugepages"		)	enable_huge_pages(to_huge_page_mode(next_arg()));
+			else if	(arg == "--threads"			)	number_of_threads				= std::stoul(next_arg());
+			else if	(arg == "--streams"			)	for (const auto & stream : load_stream_list(next_arg())) streams.push_back(stream);
+			else if	(arg == "--stream-seconds"	)	multi_stream_options.duration_seconds		= std::stod(next_arg());
+			else if	(arg == "--max-in-flight"	)	multi_stream_options.max_frames_in_flight	= std::stoul(next_arg());
+			else if	(arg == "--unpaced"			)	multi_stream_options.paced					= false;
+			else if	(arg == "--batch"			)	batch_path						= next_arg();
+			else if	(arg == "--batch-output"	)	batch_options.output_directory	= next_arg();
+			else if	(arg == "--batch-files"		)	batch_options.concurrent_files	= std::stoul(next_arg());
+			else if	(arg == "--decimate"		)	batch_options.decimation		= std::max(1ul, std::stoul(next_arg()));
+			else if	(arg == "--analysis-fps"	)	batch_options.analysis_fps		= std::stod(next_arg());
+			else if	(arg == "--cores"			)	cores							= std::stoul(next_arg());
+			else if	(arg == "--thread-policy"	)	thread_policy					= to_thread_policy(next_arg());
+			else if	(arg == "--compare-thread-policies")	compare_policies		= true;
+			else if	(arg == "--compare-tracker-assignments")	compare_assignments	= true;
+			else if	(arg == "--tracker-assignment")	TrackingSession::default_tracker_assignment	= to_tracker_assignment(next_arg());
+			else if	(arg == "--tile-size"		)	TrackingSession::default_tile_size			= std::stoi(next_arg());
+			else if	(arg == "--shards"			)	{ sharded = true; shard_options.workers = std::stoul(next_arg()); }
+			else if	(arg == "--shard-output"	)	shard_options.output_filename	= next_arg();
+			else if	(arg == "--numa"			)	numa = batch_options.numa = multi_stream_options.numa = shard_options.numa = true;
+			else if	(arg == "--config"			)
+			{
+				const PipelineConfig config = load_pipeline_config(next_arg());
+				show_pipeline_config(config);
+				set_tracker_profiles(config.profiles, config.object_profiles);
+				TrackingSession::default_maximum_size	= config.tracking_size;
+				TrackingSession::default_region			= config.region;
+				TrackingSession::default_duplicate_tolerance	= config.duplicate_tolerance;
+				TrackingSession::default_motion_compensation	= config.motion_compensation;
+				TrackingSession::default_compact_frames			= config.compact_frames;
+				TrackingSession::default_tracker_assignment		= config.tracker_assignment;
+				TrackingSession::default_tile_size				= config.tile_size;
+				capture_backend_options.backend			= config.capture_backend;
+				display_size							= config.display_size;
+				backpressure							= config.backpressure;
+				enable_object_tracking					= config.enable_object_tracking;
+				number_of_threads						= config.threads;
+				frames_in_flight						= config.frames_in_flight;
+			}
+			else if	(arg == "--duplicate-tolerance")	TrackingSession::default_duplicate_tolerance	= std::stoi(next_arg());
+			else if	(arg == "--motion-compensation")	TrackingSession::default_motion_compensation	= true;
+			else if	(arg == "--compact-frames"	)	TrackingSession::default_compact_frames		= true;
+			else if	(arg == "--capture-backend"	)	capture_backend_options.backend			= next_arg();
+			else if	(arg == "--probe-backends"	)	{ capture_backend_options.backend = "auto"; capture_backend_options.probe = true; }
+			else if	(arg == "--probe-frames"	)	capture_backend_options.probe_frames	= std::stoul(next_arg());
+			else if	(arg == "--backend-cache"	)	capture_backend_options.cache_filename	= next_arg();
+			else if	(arg == "--annotations"		)	annotation_filename				= next_arg();
+			else if	(arg == "--annotation-format")	annotation_format			= to_annotation_format(next_arg());
+			else if	(arg == "--annotation-units")	annotation_units			= to_annotation_units(next_arg());
+			else if	(arg == "--autotune"		)	{ autotune = true; autotune_options.budget_milliseconds = std::stod(next_arg()); }
+			else if	(arg == "--autotune-candidates")	autotune_options.candidates	= std::stoul(next_arg());
+			else if	(arg == "--autotune-frames"	)	autotune_options.frames			= std::stoul(next_arg());
+			else if	(arg == "--autotune-output"	)	autotune_options.output_filename	= next_arg();
+			else if	(arg == "--decoder-cpus"	)	set_stage_cpus(PipelineStage::decoder, parse_cpu_list(next_arg()));
+			else if	(arg == "--worker-cpus"		)	set_stage_cpus(PipelineStage::workers, parse_cpu_list(next_arg()));
+			else if (arg.compare(0, 2, "--") == 0)
+			{
+				throw std::invalid_argument("unknown option " + arg);
+			}
+			else
+			{
+				filename = arg;
+				StreamOptions stream;
+				stream.filename = arg;
+				streams.push_back(stream);
+			}
 		}
-		else
+
+		set_capture_backend_options(capture_backend_options);
+
+		if (annotation_filename.empty() == false)
 		{
+			if (batch_path.empty() == false or streams.size() > 1)
+			{
+				// every video would be seeded with the boxes of this one, and only at its first frame
+				throw std::invalid_argument("--annotations describes a single video and cannot be used with --batch or more than one stream");
+			}
+			annotations.reset(new AnnotationReader(annotation_filename, annotation_format, annotation_units));
+			annotations->get_seeds(0, initial_seeds);
+			std::cout << "-> " << initial_seeds.size() << " objects in the first frame of " << annotation_filename << std::endl;
+			if (sharded or compare_policies or compare_assignments or benchmark_frames > 0)
+			{
+				std::cout << "-> boxes for later frames are ignored since the video isn't shown" << std::endl;
+			}
 		}
 
-		initialize_video(filename);
-		cv::Mat mat = get_first_frame();
+		// all of the modes which track without displaying anything use the same trackers as the interactive mode
+		auto initialize = [](TrackingSession & session, cv::Mat & mat)
+		{
+			if (enable_object_tracking)
+			{
+				initialize_trackers(session, mat, session.name);
+			}
+		};
+
+		batch_options.cores			= cores;
+		batch_options.thread_policy	= thread_policy;
+		shard_options.cores			= cores;
+		shard_options.thread_policy	= thread_policy;
+
+		if (batch_path.empty() == false)
+		{
+			return run_batch(load_batch(batch_path), batch_options, initialize) ? 0 : 3;
+		}
+
+		if (streams.size() == 1)
+		{
+			filename = streams.front().filename;
+		}
+
+		if (sharded)
+		{
+			// this needs to happen before any threads are started
+			return run_shards(filename, shard_options, initialize) ? 0 : 3;
+		}
+
+		if (compare_policies)
+		{
+			compare_thread_policies(filename, cores, benchmark_frames > 0 ? benchmark_frames : 300, initialize);
+			return 0;
+		}
+
+		if (compare_assignments)
+		{
+			compare_tracker_assignments(filename, cores, benchmark_frames > 0 ? benchmark_frames : 300, initialize);
+			return 0;
+		}
+
+		if (numa and streams.size() <= 1)
+		{
+			// a single video is kept entirely on the first node
+			pin_thread_to_numa_node(0);
+			if (cores == 0)
+			{
+				cores = get_numa_nodes().front().cpus.size();
+			}
+		}
+
+		// the main thread decodes, displays, and feeds the worker pool
+		pin_thread_to_stage(PipelineStage::decoder);
+		register_thread("decoder");
+
+		// the main thread reads and shows the frames; the rest of the cores go to the worker pool and to OpenCV
+		const ThreadBudget budget = make_thread_budget(cores, thread_policy);
+		apply_thread_budget(budget);
+		show_thread_budget(budget);
+
+		const size_t worker_threads = (number_of_threads > 0 ? number_of_threads : budget.worker_threads);
+
+		if (streams.size() > 1)
+		{
+			// more than one input means all of them are tracked at once without being displayed; the pools are created there
+			return run_multi_stream(worker_threads, streams, multi_stream_options, initialize) ? 0 : 3;
+		}
+
+		WorkerPool pool(worker_threads, numa ? 0 : -1);
+
+		TrackingSession session(pool);
+		session.open(filename);
+
+		if (autotune)
+		{
+			// the annotations are the ground truth for as much of the video as is tracked
+			VAnnotationSeeds truth = initial_seeds;
+			if (annotations)
+			{
+				annotations->get_seeds(autotune_options.frames, truth);
+			}
+			return run_autotune(session, truth, autotune_options) ? 0 : 3;
+		}
+
+		if (soak)
+		{
+			return run_soak(session, soak_options) ? 0 : 3;
+		}
+
+		cv::Mat mat = session.get_first_frame();
 		if (enable_object_tracking)
 		{
-			initialize_trackers(mat, filename);
+			initialize_trackers(session, mat, filename);
 		}
-		pause_on_first_frame(mat);
-		show_video();
+
+		if (benchmark_frames > 0)
+		{
+			run_benchmark(session, benchmark_frames);
+			if (numa)
+			{
+				show_numa_stats({&pool});
+			}
+			show_thread_stats();
+			return 0;
+		}
+
+		pause_on_first_frame(session, mat);
+		show_video(session);
 
 		// and pause again on the last frame which was shown
 		std::cout << "Done! Press any key to exit." << std::endl;
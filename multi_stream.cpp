@@ -0,0 +1,386 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "multi_stream.hpp"
+#include "affinity.hpp"
+#include "numa.hpp"
+#include "stats.hpp"
+#include <csignal>
+#include <fstream>
+#include <sstream>
+
+
+/// Set by the signal handler when CTRL+C is pressed so the streams can be drained and the statistics shown.
+static volatile std::sig_atomic_t multi_stream_interrupted = 0;
+
+
+static void multi_stream_signal_handler(int)
+{
+	multi_stream_interrupted = 1;
+}
+
+
+typedef std::chrono::high_resolution_clock::time_point TimePoint;
+
+
+/// Everything the scheduler needs to know about one stream.
+struct Stream
+{
+	StreamOptions options;
+	std::string label;
+	std::unique_ptr<TrackingSession> session;
+	int numa_node = -1;	///< the frames and trackers of this stream are kept on this node
+
+	double		virtual_time	= 0.0;		///< share of the pool used so far, divided by the weight
+	bool		ended			= false;	///< the input has no more frames
+	TimePoint	next_frame_time;			///< when the next frame is "delivered" by the camera
+
+	/// The newest frame which has not yet been admitted.  It is replaced (and dropped) if a newer frame arrives. @{
+	cv::Mat		waiting;
+	TimePoint	waiting_since;
+	/// @}
+
+	std::deque<TimePoint> capture_times;	///< one entry per frame in flight, used to measure the latency
+
+	/// Statistics since the last report. @{
+	LatencySamples latencies;
+	size_t tracked		= 0;
+	size_t shed			= 0;
+	size_t late			= 0;
+	size_t missed		= 0;
+	/// @}
+
+	/// Statistics for the entire run. @{
+	size_t total_tracked	= 0;
+	size_t total_shed		= 0;
+	size_t total_late		= 0;
+	size_t total_missed		= 0;
+	/// @}
+};
+
+
+VStreamOptions load_stream_list(const std::string & filename)
+{
+	std::ifstream ifs(filename);
+	if (ifs.good() == false)
+	{
+		throw std::invalid_argument("failed to open stream list " + filename);
+	}
+
+	VStreamOptions streams;
+	std::string line;
+	while (std::getline(ifs, line))
+	{
+		std::istringstream iss(line);
+		StreamOptions stream;
+		if (not (iss >> stream.filename) or stream.filename[0] == '#')
+		{
+			continue;
+		}
+
+		iss >> stream.weight >> stream.priority >> stream.latency_target_ms;
+		if (stream.weight <= 0.0)
+		{
+			throw std::invalid_argument("weight for " + stream.filename + " must be greater than zero");
+		}
+		streams.push_back(stream);
+	}
+
+	return streams;
+}
+
+
+/// Show the statistics collected since the last report, then reset them.
+static void report(std::vector<Stream> & streams, const double seconds)
+{
+	for (auto & s : streams)
+	{
+		std::cout
+			<< "-> " << s.label << ": "
+			<< std::fixed << std::setprecision(1)
+			<< s.tracked / seconds << " FPS tracked, "
+			<< (s.shed + s.late) / seconds << " FPS dropped (" << s.late << " late), "
+			<< std::setprecision(2)
+			<< "p50=" << s.latencies.quantile(0.50) << " ms, "
+			<< "p99=" << s.latencies.quantile(0.99) << " ms";
+		if (s.options.latency_target_ms > 0.0)
+		{
+			std::cout << ", " << s.missed << " over the " << s.options.latency_target_ms << " ms target";
+		}
+		std::cout << std::endl;
+
+		s.latencies.clear();
+		s.tracked	= 0;
+		s.shed		= 0;
+		s.late		= 0;
+		s.missed	= 0;
+	}
+
+	return;
+}
+
+
+bool run_multi_stream(const size_t threads, const VStreamOptions & stream_options, const MultiStreamOptions & options, TrackerInitializer initialize)
+{
+	if (stream_options.empty())
+	{
+		throw std::invalid_argument("no streams to track");
+	}
+
+	/* With NUMA enabled, each node gets its own pool and the streams are spread across the nodes.  Otherwise all of
+	 * the streams share a single pool.
+	 */
+	std::vector<std::unique_ptr<WorkerPool>> pools;
+	std::vector<const WorkerPool *> all_pools;
+	const VNumaNodes & nodes = get_numa_nodes();
+	if (options.numa)
+	{
+		size_t total_cpus = 0;
+		for (const auto & node : nodes)
+		{
+			total_cpus += node.cpus.size();
+		}
+		for (size_t idx = 0; idx < nodes.size(); idx ++)
+		{
+			pools.emplace_back(new WorkerPool(std::max<size_t>(1, threads * nodes[idx].cpus.size() / total_cpus), idx));
+		}
+	}
+	else
+	{
+		pools.emplace_back(new WorkerPool(threads));
+	}
+	for (const auto & p : pools)
+	{
+		all_pools.push_back(p.get());
+	}
+
+	size_t total_threads = 0;
+	for (const auto p : all_pools)
+	{
+		total_threads += p->size();
+	}
+
+	std::vector<Stream> streams(stream_options.size());
+	for (size_t idx = 0; idx < streams.size(); idx ++)
+	{
+		Stream & s = streams[idx];
+		s.options	= stream_options[idx];
+		s.label		= "#" + std::to_string(idx) + " " + s.options.filename;
+
+		if (options.numa)
+		{
+			// everything this thread allocates for the stream (frames, initial tracker models) should come from its node
+			s.numa_node = idx % nodes.size();
+			s.label += " (node " + std::to_string(nodes[s.numa_node].id) + ")";
+			prefer_numa_node_memory(s.numa_node);
+		}
+
+		s.session.reset(new TrackingSession(*pools[options.numa ? s.numa_node : 0]));
+		s.session->open(s.options.filename);
+
+		cv::Mat mat = s.session->get_first_frame();
+		initialize(*s.session, mat);
+	}
+
+	const size_t max_frames_in_flight = (options.max_frames_in_flight > 0 ? options.max_frames_in_flight : total_threads);
+
+	// each stream can have 2 frames in flight so its next frame is already queued when the current one finishes
+	const size_t max_frames_in_flight_per_stream = 2;
+
+	std::cout
+		<< "-> tracking " << streams.size() << " streams on " << total_threads << " worker threads"
+		<< " with up to " << max_frames_in_flight << " frames in flight"
+		<< (options.duration_seconds > 0.0 ? "" : " (press CTRL+C to stop)")
+		<< std::endl;
+
+	multi_stream_interrupted = 0;
+	auto previous_handler = std::signal(SIGINT, multi_stream_signal_handler);
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+	const auto report_duration = std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(options.report_seconds));
+	auto previous_report_time = start_time;
+	double virtual_clock = 0.0;
+
+	for (auto & s : streams)
+	{
+		s.next_frame_time = start_time;
+	}
+
+	while (multi_stream_interrupted == 0)
+	{
+		const auto now = std::chrono::high_resolution_clock::now();
+		bool idle = true;
+
+		// collect the results of every frame which has finished
+		size_t frames_in_flight = 0;
+		for (auto & s : streams)
+		{
+			FrameResults results;
+			while (s.session->pull_results(results, false))
+			{
+				const double milliseconds = std::chrono::duration<double, std::milli>(now - s.capture_times.front()).count();
+				s.capture_times.pop_front();
+				s.latencies.add(milliseconds);
+				s.tracked ++;
+				s.total_tracked ++;
+				if (s.options.latency_target_ms > 0.0 and milliseconds > s.options.latency_target_ms)
+				{
+					s.missed ++;
+					s.total_missed ++;
+				}
+				idle = false;
+			}
+			frames_in_flight += s.capture_times.size();
+		}
+
+		// read the next frame from every stream where one is due
+		const bool looping = (options.duration_seconds > 0.0);
+		for (auto & s : streams)
+		{
+			if (s.ended or (options.paced and now < s.next_frame_time) or (options.paced == false and s.waiting.empty() == false))
+			{
+				continue;
+			}
+
+			prefer_numa_node_memory(s.numa_node);
+
+			cv::Mat mat;
+			if (s.session->read_frame(mat) == false)
+			{
+				if (looping == false or s.session->cap.rewind() == false or s.session->read_frame(mat) == false)
+				{
+					s.ended = true;
+					continue;
+				}
+			}
+
+			if (s.waiting.empty() == false)
+			{
+				// the previous frame was never admitted
+				s.shed ++;
+				s.total_shed ++;
+			}
+			else if (s.capture_times.empty())
+			{
+				// a stream which has been idle doesn't get to catch up on the share it didn't use
+				s.virtual_time = std::max(s.virtual_time, virtual_clock);
+			}
+
+			s.waiting		= mat;
+			s.waiting_since	= (options.paced ? s.next_frame_time : now);
+			s.next_frame_time += s.session->frame_duration;
+			if (s.next_frame_time < now)
+			{
+				// decoding cannot keep up with this input; don't try to make up for lost time
+				s.next_frame_time = now;
+			}
+			idle = false;
+		}
+
+		// drop the frames which are already too old to be useful
+		for (auto & s : streams)
+		{
+			if (s.waiting.empty() == false and s.options.latency_target_ms > 0.0 and std::chrono::duration<double, std::milli>(now - s.waiting_since).count() > s.options.latency_target_ms)
+			{
+				s.waiting.release();
+				s.late ++;
+				s.total_late ++;
+			}
+		}
+
+		// admit frames:  highest priority first, then whichever stream has used the least of its share
+		while (frames_in_flight < max_frames_in_flight)
+		{
+			Stream * next = nullptr;
+			for (auto & s : streams)
+			{
+				if (s.waiting.empty() or s.capture_times.size() >= max_frames_in_flight_per_stream)
+				{
+					continue;
+				}
+				if (next == nullptr or
+					s.options.priority > next->options.priority or
+					(s.options.priority == next->options.priority and s.virtual_time < next->virtual_time))
+				{
+					next = &s;
+				}
+			}
+			if (next == nullptr)
+			{
+				break;
+			}
+
+			virtual_clock = next->virtual_time;
+			next->virtual_time += 1.0 / next->options.weight;
+			next->capture_times.push_back(next->waiting_since);
+			next->session->push_frame(next->waiting);
+			next->waiting.release();
+			frames_in_flight ++;
+			idle = false;
+		}
+
+		if (now - previous_report_time >= report_duration)
+		{
+			report(streams, std::chrono::duration<double>(now - previous_report_time).count());
+			previous_report_time = now;
+		}
+
+		const bool all_ended = std::all_of(streams.begin(), streams.end(), [](const Stream & s) { return s.ended and s.waiting.empty(); });
+		if ((all_ended and frames_in_flight == 0) or (looping and now - start_time >= std::chrono::duration<double>(options.duration_seconds)))
+		{
+			break;
+		}
+
+		if (idle)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+		}
+	}
+
+	std::signal(SIGINT, previous_handler);
+	prefer_numa_node_memory(-1);
+
+	// wait for the frames which are still being tracked
+	for (auto & s : streams)
+	{
+		FrameResults results;
+		while (s.session->pull_results(results))
+		{
+			s.capture_times.pop_front();
+			s.total_tracked ++;
+		}
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+	bool all_targets_met = true;
+
+	size_t steals = 0;
+	for (const auto p : all_pools)
+	{
+		steals += p->get_steal_count();
+	}
+
+	std::cout << "-> multi-stream finished after " << std::fixed << std::setprecision(1) << seconds << " seconds (" << steals << " tasks stolen between workers)" << std::endl;
+	for (const auto & s : streams)
+	{
+		// a stream meets its target if 99% of the frames it was given were tracked within the target
+		const size_t frames = s.total_tracked + s.total_shed + s.total_late;
+		const bool met = (s.options.latency_target_ms <= 0.0 or frames == 0 or (s.total_shed + s.total_late + s.total_missed) <= frames / 100);
+		all_targets_met = all_targets_met and met;
+
+		std::cout
+			<< "-> " << s.label << " (weight " << s.options.weight << ", priority " << s.options.priority << "): "
+			<< s.total_tracked << " frames tracked, " << s.total_shed << " dropped under load, " << s.total_late << " dropped as late"
+			<< (s.options.latency_target_ms > 0.0 ? (met ? ", latency target met" : ", LATENCY TARGET MISSED") : "")
+			<< std::endl;
+	}
+
+	if (options.numa)
+	{
+		show_numa_stats(all_pools);
+	}
+	show_thread_stats();
+
+	return all_targets_met;
+}
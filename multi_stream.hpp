@@ -0,0 +1,47 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "tracking_session.hpp"
+
+
+/// How one input is scheduled when several are tracked at once.  See @ref run_multi_stream().
+struct StreamOptions
+{
+	std::string	filename;
+	double		weight				= 1.0;	///< relative share of the worker pool compared to the other streams
+	int			priority			= 0;	///< under overload, frames are dropped from the lowest priority streams first
+	double		latency_target_ms	= 0.0;	///< frames older than this are dropped instead of tracked; zero means no target
+};
+
+typedef std::vector<StreamOptions> VStreamOptions;
+
+
+/// Settings which apply to all of the streams.  See @ref run_multi_stream().
+struct MultiStreamOptions
+{
+	double	duration_seconds		= 0.0;	///< loop the inputs for this long; zero means stop once every input has ended
+	double	report_seconds			= 5.0;	///< how often the per-stream statistics are shown
+	size_t	max_frames_in_flight	= 0;	///< frames being tracked across all streams; zero means one per worker thread
+	bool	paced					= true;	///< read each input at its own frame rate, the same way a camera delivers frames
+	bool	numa					= false;	///< spread the streams across the NUMA nodes, each with its own worker pool
+};
+
+
+/** Read a list of streams from a text file.  Each line is a filename optionally followed by the weight, priority and
+ * latency target in milliseconds, separated by whitespace.  Blank lines and lines starting with @p # are ignored.
+ */
+VStreamOptions load_stream_list(const std::string & filename);
+
+
+/** Track several inputs at once in this process, each one in its own @ref TrackingSession, with all of the tracker
+ * updates running on a shared pool of @p threads workers (with NUMA enabled, one pool per node which share those
+ * threads between them).  Frames are admitted using weighted fair queueing:  the stream which has used the least of
+ * its share goes next, but higher priority streams always go before lower priority ones.  When frames
+ * arrive faster than they can be tracked, the frames which cannot be admitted are dropped -- so the low priority
+ * streams are the first to shed load -- as are frames which have already missed their stream's latency target.
+ *
+ * @returns @p true if every stream met its latency target, meaning at least 99% of its frames were tracked within the target.
+ */
+bool run_multi_stream(const size_t threads, const VStreamOptions & streams, const MultiStreamOptions & options, TrackerInitializer initialize);
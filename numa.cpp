@@ -0,0 +1,237 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "numa.hpp"
+#include "affinity.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+/// Memory policies from <linux/mempolicy.h>.  We call the syscalls directly so we don't need libnuma. @{
+static const int mpol_default	= 0;
+static const int mpol_preferred	= 1;
+static const int mpol_bind		= 2;
+/// @}
+
+/// Enough bits for the node masks given to the memory policy syscalls.
+static const size_t max_nodes = 1024;
+
+static thread_local int thread_numa_node = -1;
+
+
+static VNumaNodes find_numa_nodes()
+{
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	sched_getaffinity(0, sizeof(allowed), &allowed);
+
+	VNumaNodes nodes;
+	std::ifstream online("/sys/devices/system/node/online");
+	std::string line;
+	if (std::getline(online, line))
+	{
+		for (const int id : parse_cpu_list(line))
+		{
+			std::ifstream ifs("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+			std::string cpulist;
+			std::getline(ifs, cpulist);
+
+			NumaNode node;
+			node.id = id;
+			for (const int cpu : parse_cpu_list(cpulist))
+			{
+				if (CPU_ISSET(cpu, &allowed))
+				{
+					node.cpus.push_back(cpu);
+				}
+			}
+			if (node.cpus.empty() == false)
+			{
+				nodes.push_back(node);
+			}
+		}
+	}
+
+	if (nodes.empty())
+	{
+		// no NUMA information, so pretend everything is on a single node
+		NumaNode node;
+		node.id = 0;
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu ++)
+		{
+			if (CPU_ISSET(cpu, &allowed))
+			{
+				node.cpus.push_back(cpu);
+			}
+		}
+		nodes.push_back(node);
+	}
+
+	return nodes;
+}
+
+
+const VNumaNodes & get_numa_nodes()
+{
+	static const VNumaNodes nodes = find_numa_nodes();
+
+	return nodes;
+}
+
+
+bool pin_thread_to_numa_node(const size_t node)
+{
+	const VNumaNodes & nodes = get_numa_nodes();
+	if (node >= nodes.size())
+	{
+		return false;
+	}
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	for (const int cpu : nodes[node].cpus)
+	{
+		CPU_SET(cpu, &cpus);
+	}
+	const bool pinned = (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0);
+
+	return prefer_numa_node_memory(node) and pinned;
+}
+
+
+bool prefer_numa_node_memory(const int node)
+{
+	if (node == thread_numa_node)
+	{
+		return true;
+	}
+
+	const VNumaNodes & nodes = get_numa_nodes();
+	if (node >= static_cast<int>(nodes.size()))
+	{
+		return false;
+	}
+
+	thread_numa_node = node;
+
+	if (node < 0)
+	{
+		return syscall(SYS_set_mempolicy, mpol_default, nullptr, 0) == 0;
+	}
+
+	unsigned long mask[max_nodes / (8 * sizeof(unsigned long))] = {};
+	const size_t id = nodes[node].id;
+	mask[id / (8 * sizeof(unsigned long))] = 1UL << (id % (8 * sizeof(unsigned long)));
+
+	return syscall(SYS_set_mempolicy, mpol_preferred, mask, max_nodes) == 0;
+}
+
+
+int get_thread_numa_node()
+{
+	return thread_numa_node;
+}
+
+
+bool bind_memory_to_numa_node(void * ptr, const size_t bytes, const size_t node)
+{
+	const VNumaNodes & nodes = get_numa_nodes();
+	if (node >= nodes.size())
+	{
+		return false;
+	}
+
+	unsigned long mask[max_nodes / (8 * sizeof(unsigned long))] = {};
+	const size_t id = nodes[node].id;
+	mask[id / (8 * sizeof(unsigned long))] = 1UL << (id % (8 * sizeof(unsigned long)));
+
+	return syscall(SYS_mbind, ptr, bytes, mpol_bind, mask, max_nodes, 0) == 0;
+}
+
+
+std::map<size_t, size_t> get_numa_resident_bytes()
+{
+	// map the kernel's node IDs back to our indexes
+	std::map<int, size_t> index_of;
+	const VNumaNodes & nodes = get_numa_nodes();
+	for (size_t idx = 0; idx < nodes.size(); idx ++)
+	{
+		index_of[nodes[idx].id] = idx;
+	}
+
+	std::map<size_t, size_t> resident;
+	std::ifstream ifs("/proc/self/numa_maps");
+	std::string line;
+	while (std::getline(ifs, line))
+	{
+		// each line looks like:  7f0c00000000 default anon=512 dirty=512 N0=256 N1=256 kernelpagesize_kB=4
+		size_t page_size = 4096;
+		const size_t pos = line.find("kernelpagesize_kB=");
+		if (pos != std::string::npos)
+		{
+			page_size = std::stoul(line.substr(pos + 18)) * 1024;
+		}
+
+		std::stringstream ss(line);
+		std::string token;
+		while (ss >> token)
+		{
+			const size_t equal = token.find('=');
+			if (token.size() > 1 and token[0] == 'N' and std::isdigit(token[1]) and equal != std::string::npos)
+			{
+				const int id = std::stoi(token.substr(1, equal - 1));
+				if (index_of.count(id))
+				{
+					resident[index_of[id]] += std::stoul(token.substr(equal + 1)) * page_size;
+				}
+			}
+		}
+	}
+
+	return resident;
+}
+
+
+void show_numa_stats(const std::vector<const WorkerPool *> & pools)
+{
+	const VNumaNodes & nodes = get_numa_nodes();
+	const auto resident = get_numa_resident_bytes();
+
+	for (size_t idx = 0; idx < nodes.size(); idx ++)
+	{
+		size_t threads		= 0;
+		size_t tasks		= 0;
+		double utilisation	= 0.0;
+		for (const auto pool : pools)
+		{
+			// pools which aren't pinned to a node are counted as being on the first node
+			if (std::max(0, pool->get_numa_node()) == static_cast<int>(idx))
+			{
+				threads		+= pool->size();
+				tasks		+= pool->get_task_count();
+				utilisation	+= pool->get_utilisation() * pool->size();
+			}
+		}
+
+		const auto iter = resident.find(idx);
+		std::cout
+			<< "-> NUMA node " << nodes[idx].id << " (" << nodes[idx].cpus.size() << " CPUs): "
+			<< threads << " worker threads, "
+			<< std::fixed << std::setprecision(1) << (threads > 0 ? 100.0 * utilisation / threads : 0.0) << "% busy, "
+			<< tasks << " tasks, "
+			<< (iter == resident.end() ? 0.0 : iter->second / 1048576.0) << " MiB resident"
+			<< std::endl;
+	}
+
+	return;
+}
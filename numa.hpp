@@ -0,0 +1,55 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+class WorkerPool;
+
+
+/// One NUMA node and the CPUs which belong to it.
+struct NumaNode
+{
+	int					id;
+	std::vector<int>	cpus;	///< only the CPUs this process is allowed to run on
+};
+
+typedef std::vector<NumaNode> VNumaNodes;
+
+
+/** Get the NUMA nodes from @p /sys/devices/system/node.  Nodes without any CPUs this process can use are skipped.  On
+ * machines (or kernels) without NUMA support this returns a single node with all of the CPUs.
+ */
+const VNumaNodes & get_numa_nodes();
+
+
+/** Restrict the calling thread to the CPUs of the given node, and make it prefer memory from that node for any pages
+ * it touches for the first time.  @p node is an index into @ref get_numa_nodes(), not the kernel's node ID.
+ */
+bool pin_thread_to_numa_node(const size_t node);
+
+
+/** Make the calling thread prefer memory from the given node without changing where it runs.  Use @p -1 to go back to
+ * the default policy.
+ */
+bool prefer_numa_node_memory(const int node);
+
+
+/// The node the calling thread prefers memory from, or @p -1 if it was never set.  Used to keep the memory pools node-local.
+int get_thread_numa_node();
+
+
+/// Bind a range of memory (which has not been touched yet) to the given node.
+bool bind_memory_to_numa_node(void * ptr, const size_t bytes, const size_t node);
+
+
+/// How many bytes of this process are resident on each node, according to @p /proc/self/numa_maps.  Indexed by node.
+std::map<size_t, size_t> get_numa_resident_bytes();
+
+
+/// Show the utilisation of the worker pools and the resident memory of every node.
+void show_numa_stats(const std::vector<const WorkerPool *> & pools);
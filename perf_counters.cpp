@@ -0,0 +1,89 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "perf_counters.hpp"
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+PerfCounter::PerfCounter(const Event event, const int tid, const bool include_new_threads) :
+	fd(-1)
+{
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size			= sizeof(attr);
+	attr.disabled		= 0;
+	attr.inherit		= (include_new_threads ? 1 : 0);
+	attr.exclude_kernel	= 1;
+	attr.exclude_hv		= 1;
+
+	const uint64_t read_miss	= (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS		<< 16);
+	const uint64_t read_access	= (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS	<< 16);
+
+	switch (event)
+	{
+		case Event::dtlb_loads:
+			name		= "dTLB-loads";
+			attr.type	= PERF_TYPE_HW_CACHE;
+			attr.config	= PERF_COUNT_HW_CACHE_DTLB | read_access;
+			break;
+		case Event::dtlb_load_misses:
+			name		= "dTLB-load-misses";
+			attr.type	= PERF_TYPE_HW_CACHE;
+			attr.config	= PERF_COUNT_HW_CACHE_DTLB | read_miss;
+			break;
+		case Event::llc_loads:
+			name		= "LLC-loads";
+			attr.type	= PERF_TYPE_HW_CACHE;
+			attr.config	= PERF_COUNT_HW_CACHE_LL | read_access;
+			break;
+		case Event::llc_load_misses:
+			name		= "LLC-load-misses";
+			attr.type	= PERF_TYPE_HW_CACHE;
+			attr.config	= PERF_COUNT_HW_CACHE_LL | read_miss;
+			break;
+		case Event::cpu_migrations:
+			name		= "cpu-migrations";
+			attr.type	= PERF_TYPE_SOFTWARE;
+			attr.config	= PERF_COUNT_SW_CPU_MIGRATIONS;
+			attr.exclude_kernel = 0;	// migrations are counted in the kernel
+			break;
+		case Event::context_switches:
+			name		= "context-switches";
+			attr.type	= PERF_TYPE_SOFTWARE;
+			attr.config	= PERF_COUNT_SW_CONTEXT_SWITCHES;
+			attr.exclude_kernel = 0;
+			break;
+	}
+
+	// glibc doesn't provide a wrapper for this syscall
+	fd = syscall(__NR_perf_event_open, &attr, tid, -1, -1, 0);
+
+	return;
+}
+
+
+PerfCounter::~PerfCounter()
+{
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+
+	return;
+}
+
+
+uint64_t PerfCounter::read() const
+{
+	uint64_t value = 0;
+	if (fd >= 0 and ::read(fd, &value, sizeof(value)) != sizeof(value))
+	{
+		value = 0;
+	}
+
+	return value;
+}
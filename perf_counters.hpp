@@ -0,0 +1,49 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+
+/** A single Linux hardware or software performance counter (see "man perf_event_open").  By default the counter covers
+ * the calling thread plus any threads it creates after the counter is opened.  If the kernel refuses (for example
+ * because of @p /proc/sys/kernel/perf_event_paranoid or because we're in a VM without a PMU) then @ref is_valid()
+ * returns @p false and @ref read() always returns zero.
+ */
+class PerfCounter
+{
+	public:
+
+		/// Well-known events, named after what "perf stat" calls them.
+		enum class Event
+		{
+			dtlb_loads,
+			dtlb_load_misses,
+			llc_loads,
+			llc_load_misses,
+			cpu_migrations,
+			context_switches
+		};
+
+		/** Count @p event for thread @p tid (zero means the calling thread).  Threads which it creates later are also
+		 * counted unless @p include_new_threads is @p false.
+		 */
+		PerfCounter(const Event event, const int tid = 0, const bool include_new_threads = true);
+		~PerfCounter();
+
+		PerfCounter(const PerfCounter &) = delete;
+		PerfCounter & operator=(const PerfCounter &) = delete;
+
+		bool is_valid() const { return fd >= 0; }
+
+		/// Current value of the counter since it was opened.
+		uint64_t read() const;
+
+		std::string name;
+
+	private:
+
+		int fd;
+};
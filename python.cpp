@@ -0,0 +1,217 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "tracking_session.hpp"
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <cmath>
+
+namespace py = pybind11;
+
+
+/// The tracks of one frame, as NumPy arrays with one row per object.
+struct PyFrameResults
+{
+	size_t					frame_index;
+	py::array_t<uint64_t>	ids;
+	py::array_t<double>		rects;	///< N x 4:  x, y, width, height in pixels
+	py::array_t<bool>		found;
+	py::array_t<bool>		valid;
+};
+
+
+/** Wrap a NumPy array in a cv::Mat without copying it.  The array must be H x W x 3 @p uint8 in BGR order, with the
+ * pixels of each row packed together; the rows themselves may be padded, so slices of a larger image are accepted.
+ */
+static cv::Mat to_mat(const py::array & array)
+{
+	if (py::isinstance<py::array_t<uint8_t>>(array) == false)
+	{
+		throw std::invalid_argument("frame must be a uint8 array");
+	}
+	if (array.ndim() != 3 or array.shape(2) != 3)
+	{
+		throw std::invalid_argument("frame must have a shape of (height, width, 3)");
+	}
+	if (array.strides(2) != 1 or array.strides(1) != 3 or array.strides(0) < array.shape(1) * 3)
+	{
+		throw std::invalid_argument("the pixels of each row must be contiguous; use numpy.ascontiguousarray()");
+	}
+
+	return cv::Mat(array.shape(0), array.shape(1), CV_8UC3, const_cast<void *>(array.data()), array.strides(0));
+}
+
+
+/** A @ref TrackingSession which keeps a reference to each NumPy array pushed into it until the results for that frame
+ * have been pulled, since the trackers read the array's memory directly.
+ */
+class PySession
+{
+	public:
+
+		PySession(WorkerPool & pool, const double fps) :
+			session(new TrackingSession(pool))
+		{
+			if (not (fps > 0.0))
+			{
+				throw std::invalid_argument("fps must be positive");
+			}
+
+			session->name			= "python";
+			session->verbose		= false;
+			session->fps_rounded	= std::max(1L, std::lround(fps));
+			session->frame_duration	= std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+
+			return;
+		}
+
+		~PySession()
+		{
+			// wait for the frames in flight without blocking the other Python threads
+			{
+				py::gil_scoped_release release;
+				session.reset();
+			}
+			frames.clear();
+
+			return;
+		}
+
+		void add_object(const uint64_t object_id, const std::tuple<double, double, double, double> & rect, const py::array & frame)
+		{
+			cv::Mat mat = to_mat(frame);
+			const cv::Rect2d r(std::get<0>(rect), std::get<1>(rect), std::get<2>(rect), std::get<3>(rect));
+			session->use_frame_size(mat.size());
+
+			// creating the tracker is expensive and doesn't touch any Python objects
+			py::gil_scoped_release release;
+			session->add_tracker(std::to_string(object_id), green, r, mat);
+
+			return;
+		}
+
+		void remove_object(const uint64_t object_id)
+		{
+			session->remove_tracker(std::to_string(object_id));
+
+			return;
+		}
+
+		size_t push_frame(const py::array & frame)
+		{
+			const cv::Mat mat = to_mat(frame);
+			session->use_frame_size(mat.size());
+
+			// the fingerprint and the motion estimate don't touch any Python objects
+			size_t frame_index = 0;
+			{
+				py::gil_scoped_release release;
+				frame_index = session->push_frame(mat);
+			}
+
+			// only kept once the frame is in flight, so a failed push doesn't leave an array which is never popped
+			frames.push_back(frame);
+
+			return frame_index;
+		}
+
+		/// Returns @p None once no frames are in flight, or if @p wait is @p false and the oldest frame isn't ready.
+		std::optional<PyFrameResults> pull_results(const bool wait)
+		{
+			FrameResults results;
+			bool pulled = false;
+			{
+				py::gil_scoped_release release;
+				pulled = session->pull_results(results, wait);
+			}
+			if (pulled == false)
+			{
+				return std::nullopt;
+			}
+
+			// the trackers are done with this frame, so Python may reuse the array
+			frames.pop_front();
+
+			const size_t n = results.tracks.size();
+			PyFrameResults out;
+			out.frame_index	= results.frame_index;
+			out.ids			= py::array_t<uint64_t>(n);
+			out.rects		= py::array_t<double>({n, static_cast<size_t>(4)});
+			out.found		= py::array_t<bool>(n);
+			out.valid		= py::array_t<bool>(n);
+
+			auto ids	= out.ids	.mutable_unchecked<1>();
+			auto rects	= out.rects	.mutable_unchecked<2>();
+			auto found	= out.found	.mutable_unchecked<1>();
+			auto valid	= out.valid	.mutable_unchecked<1>();
+			for (size_t idx = 0; idx < n; idx ++)
+			{
+				const TrackResult & track = results.tracks[idx];
+				ids		(idx)		= std::stoull(track.name);
+				rects	(idx, 0)	= track.rect.x;
+				rects	(idx, 1)	= track.rect.y;
+				rects	(idx, 2)	= track.rect.width;
+				rects	(idx, 3)	= track.rect.height;
+				found	(idx)		= track.found;
+				valid	(idx)		= track.valid;
+			}
+
+			return out;
+		}
+
+		/// Push one frame and wait for its results.
+		PyFrameResults track(const py::array & frame)
+		{
+			if (session->frames_in_flight() > 0)
+			{
+				throw std::logic_error("track() cannot be mixed with frames pushed by push_frame()");
+			}
+			push_frame(frame);
+
+			return *pull_results(true);
+		}
+
+		size_t frames_in_flight() const
+		{
+			return session->frames_in_flight();
+		}
+
+	private:
+
+		std::unique_ptr<TrackingSession> session;
+		std::deque<py::object> frames;	///< arrays which are in flight, oldest first
+};
+
+
+PYBIND11_MODULE(csrt, m)
+{
+	m.doc() = "CSRT object tracking.  Frames are NumPy arrays (height x width x 3, uint8, BGR) and are never copied.";
+
+	py::class_<WorkerPool>(m, "Context", "Worker threads shared by every session created from this context.")
+		.def(py::init<size_t>(), py::arg("threads") = 0, "Start this many worker threads; zero means one per CPU core.")
+		.def_property_readonly("threads", &WorkerPool::size);
+
+	py::class_<PyFrameResults>(m, "FrameResults")
+		.def_readonly("frame_index"	, &PyFrameResults::frame_index)
+		.def_readonly("ids"			, &PyFrameResults::ids		, "object IDs, as given to add_object()")
+		.def_readonly("rects"		, &PyFrameResults::rects	, "N x 4 array of x, y, width, height in pixels")
+		.def_readonly("found"		, &PyFrameResults::found	, "whether each object was found in this frame")
+		.def_readonly("valid"		, &PyFrameResults::valid	, "false once an object has been lost for 3 seconds");
+
+	py::class_<PySession>(m, "Session",
+			"Tracks the objects in one video.  Frames passed to push_frame() must not be modified until their results "
+			"have been pulled.  The first frame sets the size of the session's frames; any other size raises ValueError.  "
+			"The GIL is released while trackers are created and while waiting for results, so sessions used from "
+			"different Python threads track in parallel.")
+		.def(py::init<WorkerPool &, double>(), py::arg("context"), py::arg("fps") = 30.0, py::keep_alive<1, 2>())
+		.def("add_object"		, &PySession::add_object	, py::arg("object_id"), py::arg("rect"), py::arg("frame"),
+				"Start tracking the object at rect (x, y, width, height in pixels) in frame, starting with the next frame pushed.")
+		.def("remove_object"	, &PySession::remove_object	, py::arg("object_id"))
+		.def("push_frame"		, &PySession::push_frame	, py::arg("frame"), "Queue a frame for tracking and return its index.")
+		.def("pull_results"		, &PySession::pull_results	, py::arg("wait") = true,
+				"Results of the oldest frame in flight, or None if there are none (or they're not ready and wait is False).")
+		.def("track"			, &PySession::track			, py::arg("frame"), "Track one frame and return its results.")
+		.def_property_readonly("frames_in_flight", &PySession::frames_in_flight);
+}
@@ -0,0 +1,112 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "region.hpp"
+
+
+void RegionOfInterest::validate() const
+{
+	auto check = [](const Polygon & polygon, const std::string & what)
+	{
+		if (polygon.size() < 3)
+		{
+			throw std::invalid_argument(what + " needs at least 3 corners (not " + std::to_string(polygon.size()) + ")");
+		}
+		for (const auto & point : polygon)
+		{
+			if (point.x < 0.0 or point.x > 1.0 or point.y < 0.0 or point.y > 1.0)
+			{
+				throw std::invalid_argument(what + " corners must be normalized between 0 and 1");
+			}
+		}
+	};
+
+	if (roi.empty() == false)
+	{
+		check(roi, "ROI");
+	}
+	for (const auto & polygon : exclusions)
+	{
+		check(polygon, "exclusion");
+	}
+
+	return;
+}
+
+
+cv::Rect RegionOfInterest::get_crop(const cv::Size & video_size) const
+{
+	const cv::Rect frame(cv::Point(0, 0), video_size);
+	if (roi.empty())
+	{
+		return frame;
+	}
+
+	double left		= 1.0;
+	double top		= 1.0;
+	double right	= 0.0;
+	double bottom	= 0.0;
+	for (const auto & point : roi)
+	{
+		left	= std::min(left		, point.x);
+		top		= std::min(top		, point.y);
+		right	= std::max(right	, point.x);
+		bottom	= std::max(bottom	, point.y);
+	}
+
+	// round outwards so no part of the ROI is lost
+	const cv::Point top_left		(std::floor(left * video_size.width), std::floor(top * video_size.height));
+	const cv::Point bottom_right	(std::ceil(right * video_size.width), std::ceil(bottom * video_size.height));
+	const cv::Rect crop = cv::Rect(top_left, bottom_right) & frame;
+	if (crop.width < 16 or crop.height < 16)
+	{
+		throw std::invalid_argument("the ROI is too small (" + std::to_string(crop.width) + " x " + std::to_string(crop.height) + " pixels)");
+	}
+
+	return crop;
+}
+
+
+cv::Mat RegionOfInterest::make_mask(const cv::Size & video_size, const cv::Rect & crop, const cv::Size & size) const
+{
+	if (empty())
+	{
+		return cv::Mat();
+	}
+
+	const double horizontal_factor	= static_cast<double>(size.width)	/ crop.width;
+	const double vertical_factor	= static_cast<double>(size.height)	/ crop.height;
+
+	auto to_pixels = [&](const Polygon & polygon)
+	{
+		std::vector<cv::Point> points;
+		for (const auto & point : polygon)
+		{
+			points.push_back(cv::Point(
+				std::round((point.x * video_size.width	- crop.x) * horizontal_factor),
+				std::round((point.y * video_size.height	- crop.y) * vertical_factor)));
+		}
+		return points;
+	};
+
+	cv::Mat mask(size, CV_8UC1, cv::Scalar(0));
+	if (roi.empty() == false)
+	{
+		// start with everything blanked, then open up the inside of the ROI
+		mask.setTo(cv::Scalar(255));
+		cv::fillPoly(mask, std::vector<std::vector<cv::Point>>{to_pixels(roi)}, cv::Scalar(0));
+	}
+	for (const auto & polygon : exclusions)
+	{
+		cv::fillPoly(mask, std::vector<std::vector<cv::Point>>{to_pixels(polygon)}, cv::Scalar(255));
+	}
+
+	if (cv::countNonZero(mask) == 0)
+	{
+		// a rectangular ROI is entirely handled by the crop
+		return cv::Mat();
+	}
+
+	return mask;
+}
@@ -0,0 +1,37 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+
+/// Corners of a polygon in normalized coordinates, where (0, 0) is the top-left of the video and (1, 1) the bottom-right.
+typedef std::vector<cv::Point2d> Polygon;
+
+typedef std::vector<Polygon> VPolygons;
+
+
+/** The parts of the video which are worth tracking.  Each frame is cropped to the bounding box of the ROI before it is
+ * resized, so stands, sky and scoreboards at the edges of the frame cost nothing.  Whatever is left outside the ROI
+ * polygon or inside an exclusion polygon is blanked, so the trackers cannot latch onto it, and a tracker whose object
+ * moves into a blanked area is retired immediately.
+ */
+struct RegionOfInterest
+{
+	Polygon		roi;		///< empty means the whole frame
+	VPolygons	exclusions;	///< areas such as a scoreboard overlay which are blanked
+
+	bool empty() const { return roi.empty() and exclusions.empty(); }
+
+	/// Make sure every polygon has at least 3 corners and that every corner is within the frame.
+	void validate() const;
+
+	/// Bounding box of the ROI in pixels of a video of @p video_size.  This is the whole frame if there is no ROI.
+	cv::Rect get_crop(const cv::Size & video_size) const;
+
+	/** Mask for frames which were cropped to @p crop and then resized to @p size:  255 where the frame is blanked and 0
+	 * where it is tracked.  Returns an empty Mat if nothing needs to be blanked.
+	 */
+	cv::Mat make_mask(const cv::Size & video_size, const cv::Rect & crop, const cv::Size & size) const;
+};
@@ -0,0 +1,778 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "shard.hpp"
+#include "affinity.hpp"
+#include "numa.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+/// Everything sent between the coordinator and the worker processes is one of these fixed-size messages.
+struct ShardMessage
+{
+	enum class Type : uint32_t
+	{
+		setup,		///< coordinator to worker, with the file descriptor of the frame ring attached
+		ready,		///< worker to coordinator, once the ring has been mapped
+		add,		///< coordinator to worker:  start tracking an object using the frame in the given slot
+		remove,		///< coordinator to worker:  stop tracking an object
+		frame,		///< coordinator to worker:  update all the trackers using the frame in the given slot
+		result,		///< worker to coordinator:  where one object was found
+		frame_done	///< worker to coordinator:  all the results for this frame have been sent and the slot is no longer used
+	};
+
+	Type		type;
+	uint32_t	object;			///< add, remove and result
+	uint32_t	slot;			///< add, frame and frame_done
+	uint32_t	flags;			///< result:  see @ref found_flag and @ref valid_flag
+	uint64_t	frame_index;
+	double		x, y, w, h;		///< add and result
+	int32_t		cols, rows;		///< setup
+	uint32_t	slots, fps;		///< setup
+	char		name[64];		///< add:  the object's name, which selects its tracker profile; always terminated
+};
+
+const uint32_t found_flag = 1;
+const uint32_t valid_flag = 2;
+
+
+static bool send_message(const int fd, const ShardMessage & msg, const int attached_fd = -1)
+{
+	iovec iov = {const_cast<ShardMessage *>(&msg), sizeof(msg)};
+	msghdr header = {};
+	header.msg_iov		= &iov;
+	header.msg_iovlen	= 1;
+
+	char control[CMSG_SPACE(sizeof(int))] = {};
+	if (attached_fd >= 0)
+	{
+		header.msg_control		= control;
+		header.msg_controllen	= sizeof(control);
+		cmsghdr * cmsg			= CMSG_FIRSTHDR(&header);
+		cmsg->cmsg_level		= SOL_SOCKET;
+		cmsg->cmsg_type			= SCM_RIGHTS;
+		cmsg->cmsg_len			= CMSG_LEN(sizeof(int));
+		std::memcpy(CMSG_DATA(cmsg), &attached_fd, sizeof(int));
+	}
+
+	// MSG_NOSIGNAL so a dead worker shows up as an error instead of killing us with SIGPIPE
+	return sendmsg(fd, &header, MSG_NOSIGNAL) == sizeof(msg);
+}
+
+
+/// Returns @p false if the other side has gone away.
+static bool receive_message(const int fd, ShardMessage & msg, int * attached_fd = nullptr)
+{
+	iovec iov = {&msg, sizeof(msg)};
+	msghdr header = {};
+	header.msg_iov		= &iov;
+	header.msg_iovlen	= 1;
+
+	char control[CMSG_SPACE(sizeof(int))] = {};
+	header.msg_control		= control;
+	header.msg_controllen	= sizeof(control);
+
+	if (recvmsg(fd, &header, MSG_WAITALL) != sizeof(msg))
+	{
+		return false;
+	}
+
+	if (attached_fd)
+	{
+		*attached_fd = -1;
+		cmsghdr * cmsg = CMSG_FIRSTHDR(&header);
+		if (cmsg and cmsg->cmsg_level == SOL_SOCKET and cmsg->cmsg_type == SCM_RIGHTS)
+		{
+			std::memcpy(attached_fd, CMSG_DATA(cmsg), sizeof(int));
+		}
+	}
+
+	return true;
+}
+
+
+/// Each slot in the ring is page-aligned.
+static size_t ring_slot_bytes(const cv::Size & size)
+{
+	const size_t page_size = 4096;
+
+	return (size.area() * 3 + page_size - 1) / page_size * page_size;
+}
+
+
+/// Main loop of a worker process.
+static void shard_worker(const int fd)
+{
+	ShardMessage msg;
+	int ring_fd = -1;
+	if (receive_message(fd, msg, &ring_fd) == false or msg.type != ShardMessage::Type::setup or ring_fd < 0)
+	{
+		throw std::runtime_error("shard worker did not receive the frame ring");
+	}
+
+	const cv::Size size(msg.cols, msg.rows);
+	const size_t slot_bytes		= ring_slot_bytes(size);
+	const size_t ring_bytes		= slot_bytes * msg.slots;
+	const size_t fps_rounded	= msg.fps;
+
+	// the worker only ever reads the frames, so map the ring read-only
+	void * ring = mmap(nullptr, ring_bytes, PROT_READ, MAP_SHARED, ring_fd, 0);
+	close(ring_fd);
+	if (ring == MAP_FAILED)
+	{
+		throw std::runtime_error("shard worker failed to map the frame ring");
+	}
+
+	auto frame = [&](const uint32_t slot)
+	{
+		return cv::Mat(size, CV_8UC3, static_cast<uint8_t *>(ring) + slot * slot_bytes);
+	};
+
+	ShardMessage reply = {};
+	reply.type = ShardMessage::Type::ready;
+	send_message(fd, reply);
+
+	std::map<uint32_t, ObjectTracker> trackers;
+	while (receive_message(fd, msg))
+	{
+		if (msg.type == ShardMessage::Type::add)
+		{
+			cv::Mat mat = frame(msg.slot);
+			trackers.erase(msg.object);
+			trackers.emplace(msg.object, ObjectTracker(std::string(msg.name, strnlen(msg.name, sizeof(msg.name))), green, cv::Rect2d(msg.x, msg.y, msg.w, msg.h), mat, msg.frame_index));
+		}
+		else if (msg.type == ShardMessage::Type::remove)
+		{
+			trackers.erase(msg.object);
+		}
+		else if (msg.type == ShardMessage::Type::frame)
+		{
+			cv::Mat mat = frame(msg.slot);
+			for (auto iter = trackers.begin(); iter != trackers.end(); )
+			{
+				ObjectTracker & ot = iter->second;
+				update_tracker(ot, mat, msg.frame_index, fps_rounded, false);
+
+				reply				= {};
+				reply.type			= ShardMessage::Type::result;
+				reply.object		= iter->first;
+				reply.frame_index	= msg.frame_index;
+				reply.flags			= (ot.last_valid == msg.frame_index ? found_flag : 0) | (ot.is_valid ? valid_flag : 0);
+				reply.x				= ot.rect.x;
+				reply.y				= ot.rect.y;
+				reply.w				= ot.rect.width;
+				reply.h				= ot.rect.height;
+				send_message(fd, reply);
+
+				iter = (ot.is_valid ? std::next(iter) : trackers.erase(iter));
+			}
+
+			reply				= {};
+			reply.type			= ShardMessage::Type::frame_done;
+			reply.frame_index	= msg.frame_index;
+			reply.slot			= msg.slot;
+			send_message(fd, reply);
+		}
+	}
+
+	munmap(ring, ring_bytes);
+
+	return;
+}
+
+
+/// The coordinator's view of one worker process.
+struct ShardWorker
+{
+	pid_t				pid			= 0;
+	int					fd			= -1;
+	size_t				ring		= 0;	///< index of the ring (one per NUMA node) this worker reads
+	bool				alive		= false;
+	size_t				backlog		= 0;	///< frames sent to this worker which it hasn't finished
+	size_t				frames_done	= 0;
+	std::set<uint32_t>	objects;			///< the shard of objects owned by this worker
+};
+
+
+/// The coordinator's view of one object.
+struct ShardObject
+{
+	std::string	name;
+	cv::Rect2d	rect;						///< most recent known position
+	size_t		rect_frame_index	= 0;	///< frame where @ref rect was seen
+	bool		valid				= true;
+	size_t		worker				= 0;	///< index of the worker which owns this object
+};
+
+
+/// A frame which has been sent to the workers and is waiting for their results.
+struct ShardFrame
+{
+	size_t								slot;
+	std::vector<bool>					waiting;	///< one entry per worker
+	size_t								remaining;	///< number of workers which haven't finished this frame
+	std::map<uint32_t, TrackResult>		tracks;
+};
+
+
+/** Start a worker process.  Any file descriptors which belong to the other workers are closed in the new process.  If
+ * @p numa_node is not negative the new process is pinned to that node.  @p opencv_threads is the number of threads
+ * OpenCV may use within the new process.
+ */
+static ShardWorker start_worker(const std::vector<ShardWorker> & workers, const int numa_node, const size_t opencv_threads)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+	{
+		throw std::runtime_error("failed to create the socket for a shard worker");
+	}
+
+	// don't let the child inherit (and later repeat) whatever is still buffered
+	std::cout.flush();
+
+	const pid_t pid = fork();
+	if (pid < 0)
+	{
+		throw std::runtime_error("failed to fork a shard worker");
+	}
+
+	if (pid == 0)
+	{
+		// this is the new worker process
+		close(fds[0]);
+		for (const auto & worker : workers)
+		{
+			close(worker.fd);
+		}
+
+		int rc = 0;
+		try
+		{
+			if (pin_thread_to_stage(PipelineStage::workers, workers.size()) == false and numa_node >= 0)
+			{
+				pin_thread_to_numa_node(numa_node);
+			}
+			cv::setNumThreads(opencv_threads);
+			shard_worker(fds[1]);
+		}
+		catch (const std::exception & e)
+		{
+			std::cout << "ERROR: shard worker " << getpid() << ": " << e.what() << std::endl;
+			rc = 1;
+		}
+
+		// skip the destructors and atexit() handlers which belong to the parent
+		std::cout.flush();
+		_exit(rc);
+	}
+
+	close(fds[1]);
+
+	ShardWorker worker;
+	worker.pid		= pid;
+	worker.fd		= fds[0];
+	worker.alive	= true;
+
+	return worker;
+}
+
+
+bool run_shards(const std::string & filename, const ShardOptions & options, TrackerInitializer initialize)
+{
+	if (options.workers == 0)
+	{
+		throw std::invalid_argument("at least 1 shard worker is needed");
+	}
+
+	// the workers must be forked before this process starts any threads (including the ones within OpenCV)
+	// with NUMA enabled the workers are spread across the nodes, and each node gets its own copy of the frame ring
+	const size_t number_of_rings = (options.numa ? get_numa_nodes().size() : 1);
+
+	/* Each worker process counts as one worker thread.  Whatever is left of the budget after the coordinator and the
+	 * workers is shared out between the workers as OpenCV threads, unless the policy says OpenCV runs serially.
+	 */
+	const ThreadBudget budget = make_thread_budget(options.cores, options.thread_policy, 1);
+	const size_t opencv_threads = (budget.policy == ThreadPolicy::workers ? 1 : std::max<size_t>(1, (budget.cores - 1) / options.workers));
+
+	std::vector<ShardWorker> workers;
+	for (size_t idx = 0; idx < options.workers; idx ++)
+	{
+		const size_t ring = idx % number_of_rings;
+		workers.push_back(start_worker(workers, options.numa ? ring : -1, opencv_threads));
+		workers.back().ring = ring;
+	}
+
+	/* The session is only used to read the frames and to get the initial objects.  The trackers it creates are
+	 * never updated; the workers create their own.
+	 */
+	// the coordinator only decodes and resizes, on a single thread
+	pin_thread_to_stage(PipelineStage::decoder);
+	cv::setNumThreads(1);
+	WorkerPool pool(1);
+	TrackingSession session(pool);
+	session.open(filename);
+	cv::Mat first_frame = session.get_first_frame();
+	initialize(session, first_frame);
+
+	std::vector<ShardObject> objects;
+	for (const auto & track : session.get_tracks())
+	{
+		if (track.name.size() >= sizeof(ShardMessage::name))
+		{
+			// the workers look up the tracker profile by name, so it cannot be truncated
+			throw std::invalid_argument("shard mode needs object names shorter than " + std::to_string(sizeof(ShardMessage::name)) + " characters (not \"" + track.name + "\")");
+		}
+
+		ShardObject obj;
+		obj.name	= track.name;
+		obj.rect	= track.rect;
+		obj.worker	= options.workers;	// not assigned to any worker yet
+		objects.push_back(obj);
+	}
+
+	// create the rings and give them to the workers
+	const size_t slots		= (options.ring_slots > 0 ? options.ring_slots : 2 * options.workers + 2);
+	const size_t slot_bytes	= ring_slot_bytes(session.desired_size);
+	const size_t ring_bytes	= slot_bytes * slots;
+	std::vector<int> ring_fds;
+	std::vector<void *> rings;
+	for (size_t idx = 0; idx < number_of_rings; idx ++)
+	{
+		const int ring_fd = memfd_create("csrt-frames", MFD_CLOEXEC);
+		if (ring_fd < 0 or ftruncate(ring_fd, ring_bytes) != 0)
+		{
+			throw std::runtime_error("failed to create the shared memory frame ring");
+		}
+		void * ring = mmap(nullptr, ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, ring_fd, 0);
+		if (ring == MAP_FAILED)
+		{
+			throw std::runtime_error("failed to map the shared memory frame ring");
+		}
+		if (options.numa)
+		{
+			// nothing has been written to the ring yet, so all of its pages will come from this node
+			bind_memory_to_numa_node(ring, ring_bytes, idx);
+		}
+		ring_fds.push_back(ring_fd);
+		rings.push_back(ring);
+	}
+	auto slot_mat = [&](const size_t ring, const size_t slot)
+	{
+		return cv::Mat(session.desired_size, CV_8UC3, static_cast<uint8_t *>(rings[ring]) + slot * slot_bytes);
+	};
+
+	for (auto & worker : workers)
+	{
+		ShardMessage msg = {};
+		msg.type	= ShardMessage::Type::setup;
+		msg.cols	= session.desired_size.width;
+		msg.rows	= session.desired_size.height;
+		msg.slots	= slots;
+		msg.fps		= session.fps_rounded;
+		if (send_message(worker.fd, msg, ring_fds[worker.ring]) == false or receive_message(worker.fd, msg) == false or msg.type != ShardMessage::Type::ready)
+		{
+			throw std::runtime_error("shard worker " + std::to_string(worker.pid) + " failed to start");
+		}
+	}
+	for (const int ring_fd : ring_fds)
+	{
+		close(ring_fd);
+	}
+
+	std::ofstream csv(options.output_filename);
+	if (csv.good() == false)
+	{
+		throw std::invalid_argument("failed to open shard output file " + options.output_filename);
+	}
+	csv << "frame,name,found,x,y,width,height" << std::endl;
+
+	std::cout << "-> tracking " << objects.size() << " objects with " << workers.size() << " worker processes (" << opencv_threads << " OpenCV threads each) and " << slots << " frames in each of the " << rings.size() << " shared memory rings" << std::endl;
+
+	std::vector<size_t> slot_users(slots, 0);	///< number of workers still using each slot
+	std::vector<bool> slot_in_use(slots, false);
+	std::map<size_t, ShardFrame> frames;		///< frames in flight, by frame index
+	std::vector<uint32_t> unassigned;			///< objects which need to be given to a worker with the next frame
+	size_t next_frame_index		= 0;
+	size_t frames_written		= 0;
+	size_t last_move			= 0;
+	size_t moves				= 0;
+	bool input_ended			= false;
+
+	for (size_t idx = 0; idx < objects.size(); idx ++)
+	{
+		unassigned.push_back(idx);
+	}
+
+	auto alive_workers = [&]()
+	{
+		return std::count_if(workers.begin(), workers.end(), [](const ShardWorker & w) { return w.alive; });
+	};
+
+	// forget about a worker which has exited or crashed, and give its objects to the others
+	auto worker_died = [&](const size_t idx)
+	{
+		ShardWorker & worker = workers[idx];
+		if (worker.alive == false)
+		{
+			return;
+		}
+
+		std::cout << "-> shard worker " << worker.pid << " has stopped; moving its " << worker.objects.size() << " objects to the other workers" << std::endl;
+		worker.alive = false;
+		close(worker.fd);
+		waitpid(worker.pid, nullptr, 0);
+
+		for (auto & iter : frames)
+		{
+			ShardFrame & frame = iter.second;
+			if (frame.waiting[idx])
+			{
+				frame.waiting[idx] = false;
+				frame.remaining --;
+				slot_users[frame.slot] --;
+			}
+		}
+		for (const auto object : worker.objects)
+		{
+			unassigned.push_back(object);
+		}
+		worker.objects.clear();
+		worker.backlog = 0;
+
+		if (alive_workers() == 0)
+		{
+			throw std::runtime_error("all shard workers have stopped");
+		}
+	};
+
+	auto send_to_worker = [&](const size_t idx, const ShardMessage & msg)
+	{
+		if (send_message(workers[idx].fd, msg) == false)
+		{
+			worker_died(idx);
+			return false;
+		}
+		return true;
+	};
+
+	// when one worker falls behind, move one of its objects to the worker which is furthest ahead
+	auto rebalance = [&](const size_t frame_index)
+	{
+		size_t slowest = workers.size();
+		size_t fastest = workers.size();
+		for (size_t idx = 0; idx < workers.size(); idx ++)
+		{
+			const ShardWorker & w = workers[idx];
+			if (w.alive == false)
+			{
+				continue;
+			}
+			if (slowest == workers.size() or w.backlog > workers[slowest].backlog)
+			{
+				slowest = idx;
+			}
+			if (fastest == workers.size() or w.backlog < workers[fastest].backlog)
+			{
+				fastest = idx;
+			}
+		}
+
+		if (slowest == workers.size() or
+			slowest == fastest or
+			frame_index < last_move + options.rebalance_interval or
+			workers[slowest].backlog < workers[fastest].backlog + options.rebalance_threshold or
+			workers[slowest].objects.size() <= workers[fastest].objects.size())
+		{
+			return;
+		}
+
+		const uint32_t object = *workers[slowest].objects.begin();
+		ShardMessage msg = {};
+		msg.type	= ShardMessage::Type::remove;
+		msg.object	= object;
+		if (send_to_worker(slowest, msg))
+		{
+			// the remove arrives after the frames this worker already has, so it still sends results for those
+			workers[slowest].objects.erase(object);
+			objects[object].worker = fastest;
+			unassigned.push_back(object);
+		}
+		last_move = frame_index;
+		moves ++;
+
+		return;
+	};
+
+	// send a frame which has just been decoded into the ring to every worker which owns objects
+	auto dispatch = [&](const size_t slot)
+	{
+		const size_t frame_index = next_frame_index ++;
+		rebalance(frame_index);
+
+		// new and moved objects start tracking on this frame, using the most recent position we know about
+		while (unassigned.empty() == false)
+		{
+			const uint32_t object = unassigned.back();
+			unassigned.pop_back();
+			if (objects[object].valid == false)
+			{
+				continue;
+			}
+
+			size_t target = objects[object].worker;
+			if (target >= workers.size() or workers[target].alive == false or workers[target].objects.count(object) == 0)
+			{
+				// the object doesn't have a worker yet, or was moved by the rebalancing, so pick the best one
+				if (target >= workers.size() or workers[target].alive == false)
+				{
+					target = workers.size();
+					for (size_t idx = 0; idx < workers.size(); idx ++)
+					{
+						if (workers[idx].alive and (target == workers.size() or workers[idx].objects.size() < workers[target].objects.size()))
+						{
+							target = idx;
+						}
+					}
+				}
+
+				ShardMessage msg = {};
+				msg.type		= ShardMessage::Type::add;
+				msg.object		= object;
+				msg.slot		= slot;
+				msg.frame_index	= frame_index;
+				msg.x			= objects[object].rect.x;
+				msg.y			= objects[object].rect.y;
+				msg.w			= objects[object].rect.width;
+				msg.h			= objects[object].rect.height;
+				std::strncpy(msg.name, objects[object].name.c_str(), sizeof(msg.name) - 1);
+				if (send_to_worker(target, msg))
+				{
+					workers[target].objects.insert(object);
+					objects[object].worker = target;
+				}
+				else
+				{
+					// that worker just died and its objects were put back on the list
+					unassigned.push_back(object);
+				}
+			}
+		}
+
+		ShardFrame & frame = frames[frame_index];
+		frame.slot		= slot;
+		frame.waiting	.assign(workers.size(), false);
+		frame.remaining	= 0;
+		slot_in_use[slot] = true;
+
+		for (size_t idx = 0; idx < workers.size(); idx ++)
+		{
+			if (workers[idx].alive == false or workers[idx].objects.empty())
+			{
+				continue;
+			}
+
+			ShardMessage msg = {};
+			msg.type		= ShardMessage::Type::frame;
+			msg.slot		= slot;
+			msg.frame_index	= frame_index;
+			if (send_to_worker(idx, msg))
+			{
+				frame.waiting[idx] = true;
+				frame.remaining ++;
+				slot_users[slot] ++;
+				workers[idx].backlog ++;
+			}
+		}
+
+		return;
+	};
+
+	// write out every frame at the front of the queue which has all of its results
+	auto write_finished_frames = [&]()
+	{
+		while (frames.empty() == false and frames.begin()->second.remaining == 0)
+		{
+			const size_t frame_index = frames.begin()->first;
+			ShardFrame & frame = frames.begin()->second;
+			for (const auto & iter : frame.tracks)
+			{
+				const TrackResult & track = iter.second;
+				csv << frame_index << "," << track.name << "," << (track.found ? 1 : 0);
+				if (track.found)
+				{
+					// the results are written in the coordinates of the original video, not the cropped and resized frames
+					const cv::Rect2d r = session.frame_to_video(track.rect);
+					csv	<< std::fixed << std::setprecision(1)
+						<< "," << r.x
+						<< "," << r.y
+						<< "," << r.width
+						<< "," << r.height;
+				}
+				else
+				{
+					csv << ",,,,";
+				}
+				csv << "\n";
+			}
+
+			slot_in_use[frame.slot] = false;
+			frames.erase(frames.begin());
+			frames_written ++;
+		}
+	};
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+	auto previous_timestamp = start_time;
+
+	while (true)
+	{
+		// decode as many frames as there are free slots in the ring
+		while (input_ended == false)
+		{
+			size_t slot = 0;
+			while (slot < slots and (slot_in_use[slot] or slot_users[slot] > 0))
+			{
+				slot ++;
+			}
+			if (slot == slots)
+			{
+				break;
+			}
+
+			cv::Mat mat;
+			if (session.read_frame(mat) == false)
+			{
+				input_ended = true;
+				break;
+			}
+			for (size_t ring = 0; ring < rings.size(); ring ++)
+			{
+				cv::Mat dst = slot_mat(ring, slot);
+				mat.copyTo(dst);
+			}
+			dispatch(slot);
+		}
+
+		write_finished_frames();
+		if (input_ended and frames.empty())
+		{
+			break;
+		}
+
+		const auto now = std::chrono::high_resolution_clock::now();
+		if (now - previous_timestamp >= std::chrono::seconds(1))
+		{
+			std::cout << "-> frame #" << frames_written << ", " << std::fixed << std::setprecision(1) << frames_written / std::chrono::duration<double>(now - start_time).count() << " FPS, backlog:";
+			for (const auto & worker : workers)
+			{
+				std::cout << " " << (worker.alive ? std::to_string(worker.backlog) : "x");
+			}
+			std::cout << std::endl;
+			previous_timestamp = now;
+		}
+
+		// wait for the workers to send us something
+		std::vector<pollfd> fds;
+		std::vector<size_t> fd_workers;
+		for (size_t idx = 0; idx < workers.size(); idx ++)
+		{
+			if (workers[idx].alive)
+			{
+				fds.push_back({workers[idx].fd, POLLIN, 0});
+				fd_workers.push_back(idx);
+			}
+		}
+		if (poll(fds.data(), fds.size(), 1000) < 0 and errno != EINTR)
+		{
+			throw std::runtime_error("failed to poll the shard workers");
+		}
+
+		for (size_t n = 0; n < fds.size(); n ++)
+		{
+			if (fds[n].revents == 0)
+			{
+				continue;
+			}
+
+			const size_t idx = fd_workers[n];
+			ShardMessage msg;
+			if (receive_message(workers[idx].fd, msg) == false)
+			{
+				worker_died(idx);
+				continue;
+			}
+
+			auto iter = frames.find(msg.frame_index);
+			if (msg.type == ShardMessage::Type::result and msg.object < objects.size())
+			{
+				ShardObject & obj = objects[msg.object];
+				const bool found = (msg.flags & found_flag);
+				const cv::Rect2d rect(msg.x, msg.y, msg.w, msg.h);
+				if (found and msg.frame_index >= obj.rect_frame_index)
+				{
+					obj.rect				= rect;
+					obj.rect_frame_index	= msg.frame_index;
+				}
+				if ((msg.flags & valid_flag) == 0 and obj.worker == idx)
+				{
+					// the worker retired this tracker and has already forgotten about it
+					obj.valid = false;
+					workers[idx].objects.erase(msg.object);
+				}
+				if (iter != frames.end())
+				{
+					iter->second.tracks[msg.object] = {obj.name, green, rect, found, (msg.flags & valid_flag) != 0};
+				}
+			}
+			else if (msg.type == ShardMessage::Type::frame_done and iter != frames.end() and iter->second.waiting[idx])
+			{
+				iter->second.waiting[idx] = false;
+				iter->second.remaining --;
+				slot_users[iter->second.slot] --;
+				workers[idx].backlog --;
+				workers[idx].frames_done ++;
+			}
+		}
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+	// closing the sockets tells the workers to exit
+	bool all_alive = true;
+	for (auto & worker : workers)
+	{
+		if (worker.alive)
+		{
+			close(worker.fd);
+			waitpid(worker.pid, nullptr, 0);
+		}
+		else
+		{
+			all_alive = false;
+		}
+	}
+	for (auto ring : rings)
+	{
+		munmap(ring, ring_bytes);
+	}
+
+	std::cout
+		<< "-> sharded tracking finished:  " << frames_written << " frames in " << std::fixed << std::setprecision(1) << seconds << " seconds, "
+		<< frames_written / seconds << " FPS, " << moves << " objects moved between workers" << std::endl;
+	for (const auto & worker : workers)
+	{
+		std::cout << "-> worker " << worker.pid << ": " << worker.frames_done << " frames, " << (worker.alive ? std::to_string(worker.objects.size()) + " objects at the end" : "stopped") << std::endl;
+	}
+	std::cout << "-> results written to " << options.output_filename << std::endl;
+
+	return all_alive;
+}
@@ -0,0 +1,34 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "thread_budget.hpp"
+#include "tracking_session.hpp"
+
+
+/// Settings which control a sharded run.  See @ref run_shards().
+struct ShardOptions
+{
+	size_t			workers					= 2;					///< number of tracker processes
+	size_t			ring_slots				= 0;					///< frames in the shared memory ring; zero means 2 per worker plus 2
+	size_t			rebalance_threshold		= 3;					///< move an object when a worker is this many frames behind the fastest one
+	size_t			rebalance_interval		= 15;					///< minimum number of frames between two moves
+	std::string		output_filename			= "shards.csv";			///< position of every object in every frame
+	bool			numa					= false;				///< spread the workers across the NUMA nodes, with one frame ring per node
+	size_t			cores					= 0;					///< thread budget shared by all the processes; zero means all of the CPUs
+	ThreadPolicy	thread_policy			= ThreadPolicy::split;	///< whether the worker processes may use OpenCV's threads
+};
+
+
+/** Track the objects in one video using several processes.  This process decodes the frames into a ring buffer in
+ * shared memory and coordinates the work.  Each worker process owns a shard of the objects, reads the frames directly
+ * from the ring without copying them, and sends the new rectangles back over a Unix domain socket.  The results are
+ * merged per frame, in order, and written to @p ShardOptions::output_filename.  When a worker falls behind, one of its
+ * objects is moved to the worker which is furthest ahead.  If a worker dies, its objects are moved to the others.
+ *
+ * This must be called before any threads are started since the worker processes are forked.
+ *
+ * @returns @p true if all of the workers were still running at the end.
+ */
+bool run_shards(const std::string & filename, const ShardOptions & options, TrackerInitializer initialize);
@@ -0,0 +1,244 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "soak.hpp"
+#include "capture_backend.hpp"
+#include "frame_arena.hpp"
+#include "stats.hpp"
+#include "tracker.hpp"
+#include <csignal>
+#include <fstream>
+
+
+/// Set by the signal handler when CTRL+C is pressed so the soak can finish the current sample and exit cleanly.
+static volatile std::sig_atomic_t soak_interrupted = 0;
+
+
+static void soak_signal_handler(int)
+{
+	soak_interrupted = 1;
+}
+
+
+/// Find a rectangle which doesn't already have a tracker on it.  Returns an empty rectangle if nothing was found.
+static cv::Rect2d find_seed(const TrackingSession & session, const VTrackResults & tracks, cv::RNG & rng)
+{
+	const cv::Size & desired_size = session.desired_size;
+
+	auto is_already_tracked = [&](const cv::Rect2d & r)
+	{
+		for (const auto & track : tracks)
+		{
+			if (track.valid and (track.rect & r).area() > 0.3 * r.area())
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	if (session.cap.is_synthetic())
+	{
+		// use the ground truth from the synthetic video so we're seeding real objects
+		for (const auto & obj : session.cap.ground_truth())
+		{
+			const cv::Rect2d r = session.video_to_frame(obj.rect);
+			if (obj.visible and is_already_tracked(r) == false and (r & cv::Rect2d(0, 0, desired_size.width, desired_size.height)).area() == r.area())
+			{
+				return r;
+			}
+		}
+
+		return cv::Rect2d();
+	}
+
+	// with a real video we have no idea where the objects are, so pick a random patch -- CSRT will track anything
+	const double w = desired_size.width		* rng.uniform(0.05, 0.15);
+	const double h = desired_size.height	* rng.uniform(0.10, 0.30);
+	const cv::Rect2d r(rng.uniform(0.0, desired_size.width - w), rng.uniform(0.0, desired_size.height - h), w, h);
+
+	return is_already_tracked(r) ? cv::Rect2d() : r;
+}
+
+
+bool run_soak(TrackingSession & session, const SoakOptions & options)
+{
+	std::ofstream csv(options.output_filename);
+	if (csv.good() == false)
+	{
+		throw std::invalid_argument("failed to open soak output file " + options.output_filename);
+	}
+	csv << "elapsed_seconds,frames,loops,trackers,seeded,retired,rss_mib,heap_mib,allocations_per_frame,arena_mats_per_frame,heap_mats_per_frame,arena_chunks,p50_ms,p90_ms,p99_ms,max_ms,fps,drift" << std::endl;
+
+	const size_t max_age = std::max<size_t>(1, session.fps_rounded) * options.max_tracker_age;
+
+	soak_interrupted = 0;
+	auto previous_handler = std::signal(SIGINT, soak_signal_handler);
+
+	std::cout
+		<< "-> soak test writing a sample every " << options.sample_seconds << " seconds to " << options.output_filename
+		<< (options.duration_seconds > 0.0 ? "" : " (press CTRL+C to stop)")
+		<< std::endl;
+
+	cv::RNG rng(1234);
+	std::map<std::string, size_t> seeded_at;	///< frame where each of our trackers was seeded
+	LatencySamples latencies;
+	std::vector<double> rss_series;
+	std::vector<double> heap_series;
+	std::vector<double> p99_series;
+	size_t frame_counter			= 0;
+	size_t loops					= 0;
+	size_t seeded					= 0;
+	size_t retired					= 0;
+	size_t frames_in_sample			= 0;
+	size_t allocations_at_sample	= get_allocation_count();
+	ArenaStats arena_at_sample		= get_arena_stats();
+	bool steady						= true;
+
+	const auto start_time = std::chrono::high_resolution_clock::now();
+	const auto sample_duration = std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(options.sample_seconds));
+	auto next_sample_time = start_time + sample_duration;
+
+	while (soak_interrupted == 0)
+	{
+		const auto frame_start = std::chrono::high_resolution_clock::now();
+
+		cv::Mat mat;
+		if (session.read_frame(mat) == false)
+		{
+			// loop the input; some video backends cannot seek so re-open the file if rewinding doesn't work
+			loops ++;
+			if (session.cap.rewind() == false or session.read_frame(mat) == false)
+			{
+				if (session.cap.open(session.name, choose_capture_backend(session.name)) == false or session.read_frame(mat) == false)
+				{
+					throw std::runtime_error("failed to loop " + session.name);
+				}
+			}
+		}
+
+		// tracker churn:  forget about trackers which have been lost, retire old ones, and seed new ones
+		const VTrackResults tracks = session.get_tracks();
+		std::set<std::string> valid;
+		for (const auto & track : tracks)
+		{
+			valid.insert(track.name);
+		}
+		for (auto iter = seeded_at.begin(); iter != seeded_at.end(); )
+		{
+			if (valid.count(iter->first) == 0 or frame_counter > iter->second + max_age)
+			{
+				// removing it also frees the session's copy of a tracker which was already lost
+				session.remove_tracker(iter->first);
+				iter = seeded_at.erase(iter);
+				retired ++;
+			}
+			else
+			{
+				++ iter;
+			}
+		}
+
+		if (frame_counter % options.seed_interval == 0 and seeded_at.size() < options.max_trackers)
+		{
+			const cv::Rect2d r = find_seed(session, tracks, rng);
+			if (r.area() > 0.0)
+			{
+				const std::string name = "soak #" + std::to_string(seeded);
+				session.add_tracker(name, green, r, mat);
+				seeded_at[name] = frame_counter;
+				seeded ++;
+			}
+		}
+
+		// one frame at a time, so the latency is the time to decode, queue, track and pull a single frame
+		session.push_frame(mat);
+		FrameResults results;
+		if (session.pull_results(results) == false)
+		{
+			throw std::runtime_error("soak test lost a frame of " + session.name);
+		}
+
+		const auto frame_end = std::chrono::high_resolution_clock::now();
+		latencies.add(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+		frame_counter ++;
+		frames_in_sample ++;
+
+		const double elapsed = std::chrono::duration<double>(frame_end - start_time).count();
+		const bool finished = (options.duration_seconds > 0.0 and elapsed >= options.duration_seconds);
+		if (frame_end < next_sample_time and finished == false and soak_interrupted == 0)
+		{
+			continue;
+		}
+
+		// time to take a sample
+		const double sample_elapsed	= options.sample_seconds + std::chrono::duration<double>(frame_end - next_sample_time).count();
+		next_sample_time			= frame_end + sample_duration;
+		const size_t allocations	= get_allocation_count();
+		const ArenaStats arena		= get_arena_stats();
+		const double rss_mib		= get_rss_bytes() / 1048576.0;
+		const double heap_mib		= get_heap_in_use_bytes() / 1048576.0;
+		const double p99			= latencies.quantile(0.99);
+		rss_series	.push_back(rss_mib);
+		heap_series	.push_back(heap_mib);
+		p99_series	.push_back(p99);
+
+		std::string drift;
+		if (is_growing_monotonically(rss_series	, options.drift_window, options.drift_threshold)) drift += "rss;";
+		if (is_growing_monotonically(heap_series, options.drift_window, options.drift_threshold)) drift += "heap;";
+		if (is_growing_monotonically(p99_series	, options.drift_window, options.drift_threshold)) drift += "p99;";
+		if (drift.empty() == false)
+		{
+			drift.pop_back();
+		}
+		steady = drift.empty();
+
+		csv	<< std::fixed << std::setprecision(3)
+			<< elapsed									<< ","
+			<< frame_counter							<< ","
+			<< loops									<< ","
+			<< seeded_at.size()							<< ","
+			<< seeded									<< ","
+			<< retired									<< ","
+			<< rss_mib									<< ","
+			<< heap_mib									<< ","
+			<< static_cast<double>(allocations - allocations_at_sample) / frames_in_sample << ","
+			<< static_cast<double>(arena.arena_allocations - arena_at_sample.arena_allocations) / frames_in_sample << ","
+			<< static_cast<double>(arena.heap_allocations - arena_at_sample.heap_allocations) / frames_in_sample << ","
+			<< arena.new_chunks							<< ","
+			<< latencies.quantile(0.50)					<< ","
+			<< latencies.quantile(0.90)					<< ","
+			<< p99										<< ","
+			<< latencies.max()							<< ","
+			<< frames_in_sample / sample_elapsed		<< ","
+			<< (drift.empty() ? "-" : drift)
+			<< std::endl;
+
+		std::cout
+			<< "-> soak " << std::fixed << std::setprecision(0) << elapsed << "s: "
+			<< frame_counter << " frames, " << seeded_at.size() << " trackers, "
+			<< std::setprecision(1) << rss_mib << " MiB RSS, "
+			<< heap_mib << " MiB heap, p99=" << std::setprecision(2) << p99 << " ms"
+			<< (drift.empty() ? "" : ", DRIFT: " + drift)
+			<< std::endl;
+
+		latencies.clear();
+		frames_in_sample		= 0;
+		allocations_at_sample	= get_allocation_count();
+		arena_at_sample			= get_arena_stats();
+
+		if (finished)
+		{
+			break;
+		}
+	}
+
+	std::signal(SIGINT, previous_handler);
+
+	std::cout
+		<< "-> soak finished after " << frame_counter << " frames (" << loops << " loops, " << seeded << " trackers seeded, " << retired << " retired)" << std::endl
+		<< "-> " << (steady ? "no monotonic growth detected" : "WARNING: monotonic growth detected in the most recent samples") << std::endl;
+
+	return steady;
+}
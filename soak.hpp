@@ -0,0 +1,31 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "tracking_session.hpp"
+
+
+/// Settings which control a soak run.  See @ref run_soak().
+struct SoakOptions
+{
+	double		duration_seconds	= 0.0;			///< zero means run until CTRL+C
+	double		sample_seconds		= 10.0;			///< how often a row is added to the time series
+	std::string	output_filename		= "soak.csv";	///< CSV file with one row per sample
+	size_t		max_trackers		= 8;			///< never have more than this many trackers at once
+	size_t		seed_interval		= 15;			///< try to seed a new tracker every this many frames
+	size_t		max_tracker_age		= 30;			///< trackers are forcibly retired after this many seconds
+	size_t		drift_window		= 8;			///< number of consecutive samples used to detect growth
+	double		drift_threshold		= 0.02;			///< minimum relative growth across the window to be flagged
+};
+
+
+/** Loop over the input forever (or for @p SoakOptions::duration_seconds) without displaying anything, continuously
+ * seeding, losing and retiring trackers.  Memory usage, allocation counts and frame latency quantiles are sampled at
+ * regular intervals and written to a CSV file so they can be plotted.  Metrics which grow monotonically are flagged.
+ * Frames go through @p session and its worker pool exactly like the other modes, so leaks or drift in the queues, the
+ * workers and their arenas are seen too.
+ *
+ * @returns @p true if the last samples looked like a steady state, or @p false if some drift was detected.
+ */
+bool run_soak(TrackingSession & session, const SoakOptions & options);
@@ -0,0 +1,145 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <malloc.h>
+#include <unistd.h>
+
+
+/// Incremented by the replacement @p operator @p new and @p operator @p delete in count_allocations.cpp. @{
+std::atomic<size_t> allocation_counter(0);
+std::atomic<size_t> deallocation_counter(0);
+/// @}
+
+
+size_t get_allocation_count()
+{
+	return allocation_counter.load(std::memory_order_relaxed);
+}
+
+
+size_t get_deallocation_count()
+{
+	return deallocation_counter.load(std::memory_order_relaxed);
+}
+
+
+size_t get_rss_bytes()
+{
+	// the 2nd field in statm is the number of resident pages
+	size_t total_pages		= 0;
+	size_t resident_pages	= 0;
+	std::ifstream ifs("/proc/self/statm");
+	if (ifs >> total_pages >> resident_pages)
+	{
+		return resident_pages * sysconf(_SC_PAGESIZE);
+	}
+
+	return 0;
+}
+
+
+size_t get_runnable_thread_count()
+{
+	size_t runnable = 0;
+	std::error_code ec;
+	for (const auto & entry : std::filesystem::directory_iterator("/proc/self/task", ec))
+	{
+		// the state is the first field after the command name, which is in brackets and may contain spaces
+		std::ifstream ifs(entry.path() / "stat");
+		std::string line;
+		std::getline(ifs, line);
+		const size_t pos = line.rfind(')');
+		if (pos != std::string::npos and pos + 2 < line.size() and line[pos + 2] == 'R')
+		{
+			runnable ++;
+		}
+	}
+
+	return runnable;
+}
+
+
+size_t get_heap_in_use_bytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	const auto info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+	// older versions of glibc only have the int version, which wraps around at 2 GiB
+	const auto info = mallinfo();
+	return static_cast<unsigned int>(info.uordblks) + static_cast<unsigned int>(info.hblkhd);
+#else
+	return 0;
+#endif
+}
+
+
+double LatencySamples::quantile(const double q) const
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+
+	const size_t idx = std::min(samples.size() - 1, static_cast<size_t>(std::max(0.0, q) * samples.size()));
+	std::nth_element(samples.begin(), samples.begin() + idx, samples.end());
+
+	return samples[idx];
+}
+
+
+double LatencySamples::max() const
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+
+	return *std::max_element(samples.begin(), samples.end());
+}
+
+
+double LatencySamples::mean() const
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+
+	return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+
+bool is_growing_monotonically(const std::vector<double> & series, const size_t window, const double min_relative_growth)
+{
+	if (window < 2 or series.size() < window)
+	{
+		return false;
+	}
+
+	const size_t first = series.size() - window;
+	for (size_t idx = first + 1; idx < series.size(); idx ++)
+	{
+		if (series[idx] < series[idx - 1])
+		{
+			return false;
+		}
+	}
+
+	const double start	= series[first];
+	const double end	= series.back();
+	if (start <= 0.0)
+	{
+		return end > 0.0;
+	}
+
+	return (end - start) / start > min_relative_growth;
+}
@@ -0,0 +1,52 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+/// Resident set size of this process, in bytes.  Returns zero if it cannot be determined.
+size_t get_rss_bytes();
+
+/// Number of bytes currently handed out by malloc(), including large mmap'd blocks.  This includes OpenCV's allocations.
+size_t get_heap_in_use_bytes();
+
+/// Total number of calls made to the global C++ @p operator @p new since the process started.  Always zero in the library.
+size_t get_allocation_count();
+
+/// Total number of calls made to the global C++ @p operator @p delete since the process started.  Always zero in the library.
+size_t get_deallocation_count();
+
+/// Number of threads in this process which are currently running or waiting for a CPU, according to @p /proc/self/task.
+size_t get_runnable_thread_count();
+
+
+/// Collect latency samples (in milliseconds) and report quantiles such as p50 or p99.
+class LatencySamples
+{
+	public:
+
+		void add(const double milliseconds) { samples.push_back(milliseconds); }
+		void clear() { samples.clear(); }
+		size_t size() const { return samples.size(); }
+		bool empty() const { return samples.empty(); }
+
+		/// Get the requested quantile, where @p q is between 0.0 and 1.0.  Returns zero if there are no samples.
+		double quantile(const double q) const;
+
+		double max() const;
+		double mean() const;
+
+	private:
+
+		mutable std::vector<double> samples;
+};
+
+
+/** Determine if the last @p window values in @p series never decreased and the total growth across that window is
+ * more than @p min_relative_growth (e.g., @p 0.02 for 2%).  This is what a leak or a slow latency creep looks like.
+ */
+bool is_growing_monotonically(const std::vector<double> & series, const size_t window, const double min_relative_growth);
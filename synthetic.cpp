@@ -0,0 +1,135 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "synthetic.hpp"
+#include "cpu_dispatch.hpp"
+
+
+/// Number of extra noise rows, which also determines how often the noise pattern repeats.
+static const int noise_rows = 61;
+
+
+/// Bounce a 1-dimensional position between 0 and @p range, like a ball between two walls.
+static double bounce(const double position, const double range)
+{
+	if (range <= 0.0)
+	{
+		return 0.0;
+	}
+
+	double m = std::fmod(position, 2.0 * range);
+	if (m < 0.0)
+	{
+		m += 2.0 * range;
+	}
+
+	return (m <= range ? m : 2.0 * range - m);
+}
+
+
+SyntheticVideo::SyntheticVideo(const cv::Size s, const size_t number_of_objects, const size_t number_of_frames, const double frames_per_second, const uint64_t seed) :
+	size(s),
+	total_frames(number_of_frames),
+	fps(frames_per_second)
+{
+	if (size.width < 64 or size.height < 64 or fps <= 0.0)
+	{
+		throw std::invalid_argument("invalid synthetic video dimensions or frame rate");
+	}
+
+	cv::RNG rng(seed);
+
+	// a smooth gradient with a faint grid, so the background has some texture but doesn't look like the objects
+	background = cv::Mat(size, CV_8UC3);
+	for (int y = 0; y < size.height; y ++)
+	{
+		cv::Vec3b * row = background.ptr<cv::Vec3b>(y);
+		for (int x = 0; x < size.width; x ++)
+		{
+			const bool grid = (x % 64 == 0 or y % 64 == 0);
+			row[x] = cv::Vec3b(
+				static_cast<uchar>(40 + 60 * x / size.width),
+				static_cast<uchar>(grid ? 110 : 90),
+				static_cast<uchar>(40 + 60 * y / size.height));
+		}
+	}
+
+	noise = cv::Mat(size.height + noise_rows, size.width, CV_8UC3);
+	cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(12));
+
+	const double shortest_side = std::min(size.width, size.height);
+	for (size_t idx = 0; idx < number_of_objects; idx ++)
+	{
+		Motion m;
+		m.dimensions	= cv::Size2d(rng.uniform(0.05, 0.15) * shortest_side, rng.uniform(0.10, 0.30) * shortest_side);
+		m.start			= cv::Point2d(rng.uniform(0.0, size.width - m.dimensions.width), rng.uniform(0.0, size.height - m.dimensions.height));
+		m.velocity		= cv::Point2d(rng.uniform(-6.0, 6.0), rng.uniform(-3.0, 3.0));
+		m.colour		= cv::Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+		m.period		= std::round(fps * rng.uniform(10.0, 20.0));
+		m.hidden		= std::round(fps * rng.uniform(3.5, 6.0));	// longer than the 3 seconds trackers are given to recover
+		m.phase			= rng.uniform(0, static_cast<int>(m.period));
+		motions.push_back(m);
+	}
+
+	return;
+}
+
+
+VSyntheticObjects SyntheticVideo::objects(const size_t frame_index) const
+{
+	VSyntheticObjects v;
+	v.reserve(motions.size());
+
+	for (size_t idx = 0; idx < motions.size(); idx ++)
+	{
+		const Motion & m = motions[idx];
+		const double x = bounce(m.start.x + m.velocity.x * frame_index, size.width	- m.dimensions.width	);
+		const double y = bounce(m.start.y + m.velocity.y * frame_index, size.height	- m.dimensions.height	);
+
+		SyntheticObject obj;
+		obj.id		= idx;
+		obj.colour	= m.colour;
+		obj.rect	= cv::Rect2d(x, y, m.dimensions.width, m.dimensions.height);
+		obj.visible	= (frame_index + m.phase) % m.period < m.period - m.hidden;
+		v.push_back(obj);
+	}
+
+	return v;
+}
+
+
+void SyntheticVideo::render(const size_t frame_index, cv::Mat & mat, VSyntheticObjects * ground_truth) const
+{
+	background.copyTo(mat);
+
+	const VSyntheticObjects v = objects(frame_index);
+	for (const auto & obj : v)
+	{
+		if (obj.visible == false)
+		{
+			continue;
+		}
+
+		// a solid body, a contrasting "head" and a few stripes gives CSRT's HOG and colour features something to latch onto
+		const cv::Rect r = obj.rect;
+		const cv::Scalar contrast(255.0 - obj.colour[0], 255.0 - obj.colour[1], 255.0 - obj.colour[2]);
+		cv::rectangle(mat, r, obj.colour, cv::FILLED);
+		cv::circle(mat, cv::Point(r.x + r.width / 2, r.y + r.width / 3), std::max(2, r.width / 4), contrast, cv::FILLED);
+		for (int y = r.y + r.height / 2; y < r.y + r.height; y += std::max(4, r.height / 8))
+		{
+			cv::line(mat, cv::Point(r.x, y), cv::Point(r.x + r.width - 1, y), contrast, 2);
+		}
+	}
+
+	// scroll through the noise so consecutive frames are never identical (both mats are continuous since rows are full width)
+	const int offset = frame_index % noise_rows;
+	cpu_kernels().saturating_add(mat.data, noise.ptr(offset), mat.total() * mat.elemSize());
+
+	if (ground_truth)
+	{
+		*ground_truth = v;
+	}
+
+	return;
+}
@@ -0,0 +1,58 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+
+/// Ground truth for one of the objects drawn into a synthetic frame.
+struct SyntheticObject
+{
+	size_t		id;			///< index of the object, stable for the entire video
+	cv::Scalar	colour;		///< main colour used to draw the object
+	cv::Rect2d	rect;		///< exact position of the object in the frame
+	bool		visible;	///< @p false while the object is "occluded" and not drawn
+};
+
+typedef std::vector<SyntheticObject> VSyntheticObjects;
+
+
+/** Generate video frames without needing an input file.  A handful of textured objects bounce around a textured
+ * background, and every once in a while they disappear for a few seconds so trackers get lost and have to be retired.
+ * Each frame is a pure function of the frame index, which means seeking and looping costs nothing and the ground truth
+ * is always exact.
+ */
+class SyntheticVideo
+{
+	public:
+
+		SyntheticVideo(const cv::Size s = cv::Size(1920, 1080), const size_t number_of_objects = 6, const size_t number_of_frames = 900, const double frames_per_second = 30.0, const uint64_t seed = 1);
+
+		/// Draw frame @p frame_index into @p mat.  If @p ground_truth is not null, it is filled in with the object positions.
+		void render(const size_t frame_index, cv::Mat & mat, VSyntheticObjects * ground_truth = nullptr) const;
+
+		/// Get the ground truth for @p frame_index without drawing the frame.
+		VSyntheticObjects objects(const size_t frame_index) const;
+
+		cv::Size	size;
+		size_t		total_frames;
+		double		fps;
+
+	private:
+
+		struct Motion
+		{
+			cv::Point2d	start;
+			cv::Point2d	velocity;	///< pixels per frame
+			cv::Size2d	dimensions;
+			cv::Scalar	colour;
+			size_t		period;		///< length of one visible + hidden cycle, in frames
+			size_t		hidden;		///< number of frames at the end of each cycle where the object is hidden
+			size_t		phase;
+		};
+
+		std::vector<Motion> motions;
+		cv::Mat background;
+		cv::Mat noise;	///< a few extra rows taller than the frame so we can scroll through it
+};
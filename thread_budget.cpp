@@ -0,0 +1,99 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "thread_budget.hpp"
+#include "numa.hpp"
+#include <opencv2/opencv.hpp>
+
+
+ThreadPolicy to_thread_policy(const std::string & name)
+{
+	if (name == "workers")	return ThreadPolicy::workers;
+	if (name == "opencv")	return ThreadPolicy::opencv;
+	if (name == "split")	return ThreadPolicy::split;
+
+	throw std::invalid_argument("thread policy must be workers, opencv, or split (not \"" + name + "\")");
+}
+
+
+std::string to_string(const ThreadPolicy policy)
+{
+	switch (policy)
+	{
+		case ThreadPolicy::workers:	return "workers";
+		case ThreadPolicy::opencv:	return "opencv";
+		case ThreadPolicy::split:	return "split";
+	}
+
+	return "unknown";
+}
+
+
+ThreadBudget make_thread_budget(const size_t cores, const ThreadPolicy policy, const size_t decoder_threads)
+{
+	ThreadBudget budget;
+	budget.policy			= policy;
+	budget.decoder_threads	= decoder_threads;
+	budget.cores			= cores;
+
+	if (budget.cores == 0)
+	{
+		for (const auto & node : get_numa_nodes())
+		{
+			budget.cores += node.cpus.size();
+		}
+	}
+
+	// the decoder threads always exist, so whatever they don't use is what we can share out
+	const size_t available = (budget.cores > decoder_threads ? budget.cores - decoder_threads : 1);
+
+	switch (policy)
+	{
+		case ThreadPolicy::workers:
+		{
+			budget.worker_threads	= available;
+			budget.opencv_threads	= 1;
+			break;
+		}
+		case ThreadPolicy::opencv:
+		{
+			budget.worker_threads	= 1;
+			budget.opencv_threads	= available;
+			break;
+		}
+		case ThreadPolicy::split:
+		{
+			// keep 1 core in 4 for OpenCV; whichever thread calls parallel_for_() first gets to use those cores
+			budget.opencv_threads	= std::max<size_t>(1, available / 4);
+			budget.worker_threads	= std::max<size_t>(1, available - budget.opencv_threads + 1);
+			break;
+		}
+	}
+
+	return budget;
+}
+
+
+void apply_thread_budget(const ThreadBudget & budget)
+{
+	/* With a value of 1 OpenCV runs everything on the calling thread.  Note that zero also disables the threading
+	 * in OpenCV, while a negative value resets it to the default of one thread per CPU.
+	 */
+	cv::setNumThreads(budget.opencv_threads);
+
+	return;
+}
+
+
+void show_thread_budget(const ThreadBudget & budget)
+{
+	std::cout
+		<< "-> thread budget: " << budget.cores << " cores with the \"" << to_string(budget.policy) << "\" policy:  "
+		<< budget.decoder_threads << " decoder, "
+		<< budget.worker_threads << " worker, "
+		<< budget.opencv_threads << " OpenCV (currently " << cv::getNumThreads() << ")"
+		<< std::endl;
+
+	return;
+}
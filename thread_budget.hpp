@@ -0,0 +1,49 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+
+/** How the cores are split between our worker pool and OpenCV's internal @p parallel_for_() threads.  OpenCV's
+ * setting is global to the process, so the policy decides which of the two gets to run in parallel.
+ */
+enum class ThreadPolicy
+{
+	workers,	///< OpenCV runs serially; the worker pool gets every core (best when there are many trackers)
+	opencv,		///< a single worker thread; OpenCV gets every core (best when there is one large tracker)
+	split		///< the worker pool gets most of the cores and OpenCV keeps a few for large single-frame operations
+};
+
+ThreadPolicy to_thread_policy(const std::string & name);
+std::string to_string(const ThreadPolicy policy);
+
+
+/** How many threads each part of the application may use.  Calls to @p parallel_for_() use the calling thread plus
+ * up to @p opencv_threads - 1 extra threads from OpenCV's own pool, so the worst case number of runnable threads is
+ * @p decoder_threads + @p worker_threads + @p opencv_threads - 1, which never exceeds @p cores.
+ */
+struct ThreadBudget
+{
+	ThreadPolicy	policy;
+	size_t			cores;				///< total budget
+	size_t			decoder_threads;	///< threads outside of both pools which read, decode and export frames
+	size_t			worker_threads;		///< size of our worker pool(s)
+	size_t			opencv_threads;		///< value given to @p cv::setNumThreads()
+};
+
+
+/** Split @p cores (zero means all of the CPUs this process can use) according to @p policy.  @p decoder_threads is the
+ * number of threads the caller will run outside of the worker pool, such as the main thread or the batch file threads.
+ */
+ThreadBudget make_thread_budget(const size_t cores, const ThreadPolicy policy, const size_t decoder_threads = 1);
+
+
+/// Configure OpenCV's internal threading for this budget.  Affects the whole process.
+void apply_thread_budget(const ThreadBudget & budget);
+
+
+/// Show how the budget was split.
+void show_thread_budget(const ThreadBudget & budget);
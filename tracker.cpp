@@ -0,0 +1,139 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "tracker.hpp"
+#include "frame_arena.hpp"
+
+
+/// Set once at startup by @ref set_tracker_profiles(). @{
+static std::map<std::string, TrackerProfile> tracker_profiles;
+static std::map<std::string, std::string> object_profile_names;
+static const TrackerProfile default_tracker_profile;
+/// @}
+
+
+TrackerProfile::TrackerProfile() :
+	name("default"),
+	tracker_type("csrt"),
+	priority(0),
+	update_interval(1),
+	loss_seconds(3.0),
+	has_colour(false)
+{
+	return;
+}
+
+
+void set_tracker_profiles(const std::map<std::string, TrackerProfile> & profiles, const std::map<std::string, std::string> & object_profiles)
+{
+	for (const auto & [object_name, profile_name] : object_profiles)
+	{
+		if (profiles.count(profile_name) == 0)
+		{
+			throw std::invalid_argument("object \"" + object_name + "\" uses an unknown tracker profile \"" + profile_name + "\"");
+		}
+	}
+
+	tracker_profiles		= profiles;
+	object_profile_names	= object_profiles;
+
+	return;
+}
+
+
+const TrackerProfile & get_tracker_profile(const std::string & object_name)
+{
+	const auto object_iter = object_profile_names.find(object_name);
+	const auto profile_iter = tracker_profiles.find(object_iter == object_profile_names.end() ? "default" : object_iter->second);
+
+	return (profile_iter == tracker_profiles.end() ? default_tracker_profile : profile_iter->second);
+}
+
+
+Tracker create_tracker(const TrackerProfile & profile)
+{
+	if (profile.tracker_type == "csrt")			return cv::TrackerCSRT::create(profile.csrt_params);
+	if (profile.tracker_type == "kcf")			return cv::TrackerKCF::create();
+	if (profile.tracker_type == "mosse")		return cv::TrackerMOSSE::create();
+	if (profile.tracker_type == "mil")			return cv::TrackerMIL::create();
+	if (profile.tracker_type == "medianflow")	return cv::TrackerMedianFlow::create();
+
+	throw std::invalid_argument("tracker type must be csrt, kcf, mosse, mil, or medianflow (not \"" + profile.tracker_type + "\")");
+}
+
+
+bool tracker_needs_colour(const TrackerProfile & profile)
+{
+	return profile.tracker_type != "mosse" and profile.tracker_type != "medianflow";
+}
+
+
+bool is_tracker_due(const ObjectTracker & ot, const size_t frame_counter)
+{
+	return ot.is_valid and (ot.update_interval <= 1 or (frame_counter - ot.first_frame) % ot.update_interval == 0);
+}
+
+
+bool update_tracker(ObjectTracker & ot, cv::Mat & mat, const size_t frame_counter, const size_t fps_rounded, const bool verbose, const cv::Point & offset)
+{
+	if (ot.is_valid == false)
+	{
+		return false;
+	}
+
+	if (is_tracker_due(ot, frame_counter) == false)
+	{
+		// not this tracker's turn; if it saw the object last time then it still counts as found
+		if (ot.last_valid + 1 == frame_counter)
+		{
+			ot.last_valid = frame_counter;
+		}
+		return false;
+	}
+
+	// all the temporary Mats created by the tracker during this update come from (and go back to) this thread's arena
+	FrameArenaScope arena_scope;
+
+	// this next call takes a *LONG* time to run!
+	const bool ok = ot.tracker->update(mat, ot.rect);
+	if (ok)
+	{
+		ot.last_valid = frame_counter;
+		ot.rect.x += offset.x;
+		ot.rect.y += offset.y;
+	}
+	else
+	{
+		// we've lost the object...is it temporary?
+		ot.rect = cv::Rect2d(-1.0, -1.0, -1.0, -1.0);
+
+		if (frame_counter > ot.last_valid + fps_rounded * ot.loss_seconds)
+		{
+			if (verbose)
+			{
+				std::cout << "-> removing tracker for \"" << ot.name << "\" since object not seen since frame #" << ot.last_valid << "" << std::endl;
+			}
+			ot.is_valid = false;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+size_t update_trackers(VObjectTrackers & trackers, cv::Mat & mat, const size_t frame_counter, const size_t fps_rounded, const bool verbose)
+{
+	size_t removed = 0;
+
+	for (auto & ot : trackers)
+	{
+		if (update_tracker(ot, mat, frame_counter, fps_rounded, verbose))
+		{
+			removed ++;
+		}
+	}
+
+	return removed;
+}
@@ -0,0 +1,126 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/tracking/tracker.hpp>
+#include <map>
+
+
+typedef cv::Ptr<cv::Tracker> Tracker;	///< single object tracker (could be any OpenCV tracker, not just CSRT)
+
+
+/// How one kind of object is tracked.  Profiles are normally loaded from a configuration file (see config.hpp).
+struct TrackerProfile
+{
+	std::string				name;
+	std::string				tracker_type;		///< csrt, kcf, mosse, mil, or medianflow
+	cv::TrackerCSRT::Params	csrt_params;		///< only used by CSRT trackers
+	int						priority;			///< trackers with a higher priority are updated first
+	size_t					update_interval;	///< only update the tracker every Nth frame; the rectangle is kept in between
+	double					loss_seconds;		///< give up on an object which hasn't been seen for this long
+	bool					has_colour;			///< @p true if @ref colour replaces the one given when the tracker is created
+	cv::Scalar				colour;
+
+	TrackerProfile();
+};
+
+
+/** Use the profiles in @p profiles for the objects named in @p object_profiles, and the profile named @p "default"
+ * (if there is one) for all other objects.  This must be called before any trackers are created.
+ */
+void set_tracker_profiles(const std::map<std::string, TrackerProfile> & profiles, const std::map<std::string, std::string> & object_profiles);
+
+/// Get the profile used for objects named @p object_name.
+const TrackerProfile & get_tracker_profile(const std::string & object_name);
+
+/// Create an OpenCV tracker of the type given by @p profile.
+Tracker create_tracker(const TrackerProfile & profile);
+
+/// @p false for the tracker types which convert every frame to greyscale anyway (MOSSE and MedianFlow).
+bool tracker_needs_colour(const TrackerProfile & profile);
+
+
+struct ObjectTracker
+{
+	bool		is_valid;	///< used to detremine if this tracker should be used or skipped
+	std::string	name;		///< name we give to the tracker for debug purposes
+	cv::Scalar	colour;		///< colour we'll use to draw the output onto the mat
+	cv::Rect2d	rect;		///< last reported rectangle for this tracker
+	size_t		last_valid;	///< last frame index where this tracker reported positive results
+	size_t		first_frame;///< frame index where this tracker was created
+	int			priority;	///< from the tracker's profile
+	size_t		update_interval;	///< from the tracker's profile
+	double		loss_seconds;		///< from the tracker's profile
+	cv::Point2d	motion_origin;		///< total camera motion when the tracker was initialized; see @ref update_tracker()
+	bool		needs_colour;		///< @p false if the tracker can be given greyscale frames
+	Tracker		tracker;	///< CSRT tracker (or another type, depending on the profile)
+
+	/// Create an object Tracker from a rectangle and an image.
+	ObjectTracker(const std::string n, const cv::Scalar c, const cv::Rect2d r, cv::Mat & mat, const size_t frame_index = 0) :
+		is_valid(true),
+		name(n),
+		colour(c),
+		rect(r),
+		last_valid(frame_index),
+		first_frame(frame_index),
+		motion_origin(0.0, 0.0)
+	{
+		const TrackerProfile & profile = get_tracker_profile(name);
+		priority		= profile.priority;
+		update_interval	= profile.update_interval;
+		loss_seconds	= profile.loss_seconds;
+		needs_colour	= tracker_needs_colour(profile);
+		if (profile.has_colour)
+		{
+			colour = profile.colour;
+		}
+
+		tracker = create_tracker(profile);
+		tracker->init(mat, rect);
+		return;
+	}
+
+	/// Create an object Tracker from 4 normalized X,Y,W,H values instead of a cv::Rect2d.
+	ObjectTracker(const std::string n, const cv::Scalar c, const double x, const double y, const double w, const double h, cv::Mat & mat) :
+		ObjectTracker(n, c, cv::Rect2d(x * mat.cols, y * mat.rows, w * mat.cols, h * mat.rows), mat)
+	{
+		return;
+	}
+};
+
+
+typedef std::vector<ObjectTracker> VObjectTrackers;
+
+
+/// Remember that OpenCV uses BGR, not RGB. @{
+const cv::Scalar red	(0.0	, 0.0	, 255.0	);
+const cv::Scalar blue	(255.0	, 0.0	, 0.0	);
+const cv::Scalar green	(0.0	, 255.0	, 0.0	);
+const cv::Scalar purple	(128.0	, 0.0	, 128.0	);
+const cv::Scalar black	(0.0	, 0.0	, 0.0	);
+const cv::Scalar white	(255.0	, 255.0	, 255.0	);
+/// @}
+
+
+/// @p false if the tracker is invalid, or if its profile's update interval means it skips frame @p frame_counter.
+bool is_tracker_due(const ObjectTracker & ot, const size_t frame_counter);
+
+
+/** Update a single tracker using the given frame.  If the object hasn't been seen for the number of seconds given by
+ * the tracker's profile (3 by default) the tracker is marked as invalid.  Trackers whose profile has an update interval
+ * are only updated every Nth frame.  Returns @p true if the tracker was invalidated by this call.  Different trackers may be updated
+ * concurrently from different threads, but each individual tracker must see the frames in order.
+ *
+ * When the camera moves, @p mat can be the frame shifted back by @p offset pixels (the camera motion since the tracker
+ * was initialized) so the object is close to where the tracker last saw it.  The rectangle found is then shifted
+ * forward by @p offset so @ref ObjectTracker::rect is always in the coordinates of the real frame.
+ */
+bool update_tracker(ObjectTracker & ot, cv::Mat & mat, const size_t frame_counter, const size_t fps_rounded, const bool verbose = true, const cv::Point & offset = cv::Point());
+
+
+/** Update all the valid trackers using the given frame.  Trackers which haven't seen their object for too long are marked
+ * as invalid.  Returns the number of trackers which were invalidated by this call.
+ */
+size_t update_trackers(VObjectTrackers & trackers, cv::Mat & mat, const size_t frame_counter, const size_t fps_rounded, const bool verbose = true);
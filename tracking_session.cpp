@@ -0,0 +1,722 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "tracking_session.hpp"
+#include "capture_backend.hpp"
+
+
+cv::Size TrackingSession::default_maximum_size(1024, 768);
+RegionOfInterest TrackingSession::default_region;
+int TrackingSession::default_duplicate_tolerance = -1;
+bool TrackingSession::default_motion_compensation = false;
+bool TrackingSession::default_compact_frames = false;
+TrackerAssignment TrackingSession::default_tracker_assignment = TrackerAssignment::any;
+int TrackingSession::default_tile_size = 256;
+
+
+TrackerAssignment to_tracker_assignment(const std::string & name)
+{
+	if (name == "any")		return TrackerAssignment::any;
+	if (name == "tiles")	return TrackerAssignment::tiles;
+
+	throw std::invalid_argument("tracker assignment must be any or tiles (not \"" + name + "\")");
+}
+
+
+std::string to_string(const TrackerAssignment assignment)
+{
+	switch (assignment)
+	{
+		case TrackerAssignment::any:	return "any";
+		case TrackerAssignment::tiles:	return "tiles";
+	}
+
+	return "unknown";
+}
+
+
+TrackingSession::TrackingSession(WorkerPool & worker_pool) :
+	window_title("CSRT Example"),
+	video_size(1024, 768),
+	crop(0, 0, 1024, 768),
+	desired_size(1024, 768),
+	fps_rounded(0),
+	total_frames(0),
+	frame_duration(0),
+	verbose(true),
+	pool(worker_pool),
+	duplicates(default_duplicate_tolerance),
+	compensate_motion(default_motion_compensation),
+	compact_frames(default_compact_frames),
+	tracker_assignment(default_tracker_assignment),
+	tile_size(std::max(16, default_tile_size)),
+	current_padding(0),
+	next_frame_index(0),
+	busy(false),
+	remaining_tasks(0),
+	input_ended(false),
+	frame_size_fixed(false)
+{
+	return;
+}
+
+
+TrackingSession::~TrackingSession()
+{
+	// the worker threads hold pointers to us, so we cannot go away until they're done
+	std::unique_lock<std::mutex> lock(mutex);
+	input.clear();
+	frame_finished.wait(lock, [&] { return busy == false; });
+
+	return;
+}
+
+
+void TrackingSession::open(const std::string & filename, const cv::Size & maximum_size, const bool verbose)
+{
+	name = filename;
+	desired_size = (maximum_size.area() > 0 ? maximum_size : default_maximum_size);
+
+	const int backend = choose_capture_backend(filename);
+	cap.open(filename, backend);
+	if (cap.is_open() == false)
+	{
+		throw std::invalid_argument("failed to open " + filename);
+	}
+
+	const int width					= cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_WIDTH	);
+	const int height				= cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_HEIGHT	);
+	const size_t number_of_frames	= cap.get(cv::VideoCaptureProperties::CAP_PROP_FRAME_COUNT	);
+	const double fps				= cap.get(cv::VideoCaptureProperties::CAP_PROP_FPS			);
+	const double fpm				= fps * 60.0;
+	const double minutes			= std::floor(number_of_frames / fpm);
+	const double seconds			= (number_of_frames - (minutes * fpm)) / fps;
+
+	fps_rounded = std::round(fps);
+	total_frames = number_of_frames;
+	video_size = cv::Size(width, height);
+	crop = default_region.get_crop(video_size);
+
+	/* 1 second = 1000 milliseconds
+	 * 1 second = 1000000 microseconds
+	 * 1 second = 1000000000 nanoseconds
+	 */
+
+	const size_t length_of_each_frame_in_nanoseconds = std::round(1000000000.0 / fps);
+	frame_duration = std::chrono::nanoseconds(length_of_each_frame_in_nanoseconds);
+
+	if (verbose)
+	{
+		std::cout	<< filename << ":" << std::endl
+					<< "-> " << width << " x " << height << " @ " << fps << " FPS for "
+					<< minutes << "m" << std::fixed << std::setprecision(1) << seconds << "s"
+					<< " (" << number_of_frames << " total frames)" << std::endl
+					<< "-> decoded with the " << (cap.is_synthetic() ? "synthetic" : capture_backend_name(backend)) << " backend" << std::endl
+					<< "-> each frame is " << length_of_each_frame_in_nanoseconds << " nanoseconds"
+					<< " (" << (length_of_each_frame_in_nanoseconds / 1000000.0) << " milliseconds)" << std::endl;
+	}
+
+	if (verbose and crop.size() != video_size)
+	{
+		std::cout
+			<< "-> each frame will be cropped to the ROI:  " << crop.width << " x " << crop.height << " at " << crop.x << ", " << crop.y
+			<< " (" << std::round(100.0 * crop.area() / video_size.area()) << "% of the pixels)"
+			<< std::endl;
+	}
+
+	// figure out how much we need to zoom each frame (if they're too big to display on my screen)
+	double factor = 1.0;
+	if (crop.width > desired_size.width or crop.height > desired_size.height)
+	{
+		// we're going to have to resize each frame since they're larger than what we want to see
+		const double horizontal_factor	= static_cast<double>(desired_size.width)	/ static_cast<double>(crop.width);
+		const double vertical_factor	= static_cast<double>(desired_size.height)	/ static_cast<double>(crop.height);
+		factor							= std::max(horizontal_factor, vertical_factor);
+		desired_size = cv::Size(std::round(factor * crop.width), std::round(factor * crop.height));
+
+		if (verbose)
+		{
+			std::cout
+				<< "-> each frame will be resized to " << desired_size.width << " x " << desired_size.height
+				<< " (zoom factor of " << factor << ")"
+				<< std::endl;
+		}
+	}
+	else
+	{
+		// make the desired size match the frame dimensions so we don't resize anything
+		desired_size = crop.size();
+	}
+
+	excluded = default_region.make_mask(video_size, crop, desired_size);
+	if (verbose and excluded.empty() == false)
+	{
+		std::cout << "-> " << std::round(100.0 * cv::countNonZero(excluded) / excluded.total()) << "% of each frame will be blanked" << std::endl;
+	}
+
+	window_title = window_title + " (" + std::to_string(width) + " x " + std::to_string(height) + " @ " + std::to_string(static_cast<int>(std::round(100.0 * factor))) + "%)";
+
+	return;
+}
+
+
+void TrackingSession::use_frame_size(const cv::Size & size)
+{
+	if (frame_size_fixed)
+	{
+		if (size != desired_size)
+		{
+			throw std::invalid_argument("frame is " + std::to_string(size.width) + " x " + std::to_string(size.height) + " but this session's frames are " + std::to_string(desired_size.width) + " x " + std::to_string(desired_size.height));
+		}
+		return;
+	}
+
+	video_size			= size;
+	crop				= cv::Rect(cv::Point(0, 0), size);
+	desired_size		= size;
+	excluded			= cv::Mat();
+	frame_size_fixed	= true;
+
+	return;
+}
+
+
+bool TrackingSession::read_frame(cv::Mat & mat)
+{
+	cap >> mat;
+	if (mat.empty())
+	{
+		return false;
+	}
+
+	if (mat.size() == video_size and crop.size() != video_size)
+	{
+		// only a view, so the pixels outside the ROI are never resized
+		mat = mat(crop);
+	}
+
+	if (mat.size() != desired_size)
+	{
+		cv::Mat tmp;
+		cv::resize(mat, tmp, desired_size);
+		mat = tmp;
+	}
+
+	if (excluded.empty() == false)
+	{
+		mat.setTo(cv::Scalar::all(0), excluded);
+	}
+
+	return true;
+}
+
+
+bool TrackingSession::skip_frame()
+{
+	return cap.grab();
+}
+
+
+cv::Mat TrackingSession::get_first_frame()
+{
+	cap.set(cv::VideoCaptureProperties::CAP_PROP_POS_FRAMES, 0.0);
+	cv::Mat mat;
+	read_frame(mat);
+	cap.set(cv::VideoCaptureProperties::CAP_PROP_POS_FRAMES, 0.0);
+
+	return mat;
+}
+
+
+void TrackingSession::add_tracker(const std::string & tracker_name, const cv::Scalar & colour, const cv::Rect2d & rect, cv::Mat & mat)
+{
+	// initializing the tracker is expensive, so do it before we grab the lock
+	ObjectTracker ot(tracker_name, colour, rect, mat);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// the tracker was initialized on the frame which is about to be pushed, so it must not see the frames still queued
+	ot.last_valid = ot.first_frame = next_frame_index + input.size();
+
+	// a tracker with the same name is replaced once this one starts, which is how an object is re-seeded
+	pending_trackers.erase(std::remove_if(pending_trackers.begin(), pending_trackers.end(), [&](const ObjectTracker & pending) { return pending.name == tracker_name; }), pending_trackers.end());
+	pending_trackers.push_back(std::move(ot));
+
+	return;
+}
+
+
+void TrackingSession::add_tracker(const std::string & tracker_name, const cv::Scalar & colour, const double x, const double y, const double w, const double h, cv::Mat & mat)
+{
+	add_tracker(tracker_name, colour, video_to_frame(cv::Rect2d(x * video_size.width, y * video_size.height, w * video_size.width, h * video_size.height)), mat);
+
+	return;
+}
+
+
+cv::Rect2d TrackingSession::video_to_frame(const cv::Rect2d & rect) const
+{
+	const double horizontal_factor	= static_cast<double>(desired_size.width)	/ crop.width;
+	const double vertical_factor	= static_cast<double>(desired_size.height)	/ crop.height;
+
+	return cv::Rect2d((rect.x - crop.x) * horizontal_factor, (rect.y - crop.y) * vertical_factor, rect.width * horizontal_factor, rect.height * vertical_factor);
+}
+
+
+cv::Rect2d TrackingSession::frame_to_video(const cv::Rect2d & rect) const
+{
+	const double horizontal_factor	= static_cast<double>(crop.width)	/ desired_size.width;
+	const double vertical_factor	= static_cast<double>(crop.height)	/ desired_size.height;
+
+	return cv::Rect2d(rect.x * horizontal_factor + crop.x, rect.y * vertical_factor + crop.y, rect.width * horizontal_factor, rect.height * vertical_factor);
+}
+
+
+void TrackingSession::remove_tracker(const std::string & tracker_name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	pending_removals.insert(tracker_name);
+	pending_trackers.erase(std::remove_if(pending_trackers.begin(), pending_trackers.end(), [&](const ObjectTracker & pending) { return pending.name == tracker_name; }), pending_trackers.end());
+
+	return;
+}
+
+
+size_t TrackingSession::push_frame(const cv::Mat & mat)
+{
+	// the fingerprint and the camera motion are computed on the caller's thread, which is normally the one decoding the video
+	const bool duplicate = duplicates.is_duplicate(mat);
+	cv::Mat padded;
+	int padding = 0;
+	if (compensate_motion and duplicate == false)
+	{
+		total_motion += motion_estimator.estimate(mat);
+
+		// one padded copy per frame lets every tracker see the frame shifted by its own offset without another copy;
+		// compact frames are padded when they start tracking instead, so the queue doesn't also hold a padded BGR copy
+		padding = std::max(16, std::max(mat.cols, mat.rows) / 8);
+		if (compact_frames == false)
+		{
+			cv::copyMakeBorder(mat, padded, padding, padding, padding, padding, cv::BORDER_REPLICATE);
+		}
+	}
+
+	// the BGR frame isn't kept, so only the compact copy waits in the queue
+	CompactFrame compact;
+	if (compact_frames)
+	{
+		compact = CompactFrame(mat);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// frames start in the order they were pushed, so this one goes after those still waiting
+	const size_t frame_index = next_frame_index + input.size();
+	input.push_back({compact_frames ? cv::Mat() : mat, duplicate, total_motion, padded, padding, std::move(compact)});
+	if (busy == false)
+	{
+		start_next_frame();
+	}
+
+	return frame_index;
+}
+
+
+bool TrackingSession::pull_results(FrameResults & results, const bool wait)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (wait)
+	{
+		frame_finished.wait(lock, [&] { return error or output.empty() == false or (busy == false and input.empty()); });
+	}
+
+	if (error)
+	{
+		std::exception_ptr e = error;
+		error = nullptr;
+		std::rethrow_exception(e);
+	}
+
+	if (output.empty())
+	{
+		return false;
+	}
+
+	results = std::move(output.front());
+	output.pop_front();
+
+	return true;
+}
+
+
+size_t TrackingSession::frames_in_flight() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return input.size() + (busy ? 1 : 0) + output.size();
+}
+
+
+void TrackingSession::end_input()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	input_ended = true;
+	resume_waiting_coroutine();
+
+	return;
+}
+
+
+bool TrackingSession::wait_for_results(std::coroutine_handle<> handle)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (error or output.empty() == false or (input_ended and busy == false and input.empty()))
+	{
+		return false;
+	}
+
+	waiting = handle;
+
+	return true;
+}
+
+
+void TrackingSession::resume_waiting_coroutine()
+{
+	if (waiting and (error or output.empty() == false or (input_ended and busy == false and input.empty())))
+	{
+		auto handle = waiting;
+		waiting = nullptr;
+		pool.submit([handle] { handle.resume(); });
+	}
+
+	return;
+}
+
+
+VTrackResults TrackingSession::get_tracks() const
+{
+	// the workers update the trackers without holding the lock, so wait for the current frame to finish
+	std::unique_lock<std::mutex> lock(mutex);
+	frame_finished.wait(lock, [&] { return busy == false; });
+
+	VTrackResults tracks;
+	for (const auto & ot : trackers)
+	{
+		// a tracker which is about to be replaced is reported as its replacement
+		const bool replaced = std::any_of(pending_trackers.begin(), pending_trackers.end(), [&](const ObjectTracker & pending) { return pending.name == ot.name; });
+		if (ot.is_valid and replaced == false)
+		{
+			tracks.push_back({ot.name, ot.colour, ot.rect, ot.last_valid + 1 == next_frame_index, true});
+		}
+	}
+	for (const auto & ot : pending_trackers)
+	{
+		tracks.push_back({ot.name, ot.colour, ot.rect, true, true});
+	}
+
+	return tracks;
+}
+
+
+void TrackingSession::start_next_frame()
+{
+	while (busy == false and input.empty() == false)
+	{
+		current.frame_index	= next_frame_index ++;
+		current.frame		= input.front().mat;
+		current.compact		= std::move(input.front().compact);
+		current_bgr			= cv::Mat();
+		current.duplicate	= input.front().duplicate;
+		current.tracks.clear();
+		previous_motion		= current_motion;
+		current_motion		= input.front().motion;
+		current_padded		= input.front().padded;
+		current_padding		= input.front().padding;
+		input.pop_front();
+
+		// nothing is running, so this is the only time the set of trackers can safely be modified
+		if (pending_removals.empty() == false)
+		{
+			trackers.erase(std::remove_if(trackers.begin(), trackers.end(), [&](const ObjectTracker & ot) { return pending_removals.count(ot.name) > 0; }), trackers.end());
+			for (const auto & name : pending_removals)
+			{
+				tracker_tiles.erase(name);
+			}
+			pending_removals.clear();
+		}
+		bool added = false;
+		for (auto iter = pending_trackers.begin(); iter != pending_trackers.end(); )
+		{
+			if (iter->first_frame > current.frame_index)
+			{
+				// initialized on a frame which is still waiting behind this one
+				++ iter;
+				continue;
+			}
+
+			// new trackers were initialized on this frame, so they start from its camera position
+			ObjectTracker & ot = *iter;
+			ot.motion_origin = current_motion;
+			trackers.erase(std::remove_if(trackers.begin(), trackers.end(), [&](const ObjectTracker & old) { return old.name == ot.name; }), trackers.end());
+			tracker_tiles.erase(ot.name);
+			trackers.push_back(std::move(ot));
+			iter = pending_trackers.erase(iter);
+			added = true;
+		}
+		if (added)
+		{
+			// the tasks are queued in this order, so the most important objects are tracked first
+			std::stable_sort(trackers.begin(), trackers.end(), [](const ObjectTracker & lhs, const ObjectTracker & rhs) { return lhs.priority > rhs.priority; });
+		}
+
+		remaining_tasks = 0;
+		for (const auto & ot : trackers)
+		{
+			if (ot.is_valid)
+			{
+				remaining_tasks ++;
+			}
+		}
+
+		if (remaining_tasks > 0 and current.duplicate)
+		{
+			// the trackers would only find what they found on the previous frame, so carry those results forward
+			for (auto & ot : trackers)
+			{
+				if (ot.is_valid and ot.last_valid + 1 == current.frame_index)
+				{
+					ot.last_valid = current.frame_index;
+				}
+				current.tracks.push_back({ot.name, ot.colour, ot.rect, ot.is_valid and ot.last_valid == current.frame_index, ot.is_valid});
+			}
+			output.push_back(std::move(current));
+			frame_finished.notify_all();
+			resume_waiting_coroutine();
+			continue;
+		}
+
+		if (remaining_tasks == 0)
+		{
+			// nothing to track, so this frame is already done
+			for (const auto & ot : trackers)
+			{
+				current.tracks.push_back({ot.name, ot.colour, ot.rect, false, false});
+			}
+			output.push_back(std::move(current));
+			frame_finished.notify_all();
+			resume_waiting_coroutine();
+			continue;
+		}
+
+		busy = true;
+		submit_trackers();
+	}
+
+	return;
+}
+
+
+void TrackingSession::submit_trackers()
+{
+	if (tracker_assignment == TrackerAssignment::any or pool.size() < 2)
+	{
+		for (size_t idx = 0; idx < trackers.size(); idx ++)
+		{
+			if (trackers[idx].is_valid)
+			{
+				pool.submit([this, idx] { run_tracker(idx); });
+			}
+		}
+
+		return;
+	}
+
+	const int columns	= std::max(1, (desired_size.width	+ tile_size - 1) / tile_size);
+	const int rows		= std::max(1, (desired_size.height	+ tile_size - 1) / tile_size);
+	if (tile_workers.size() != static_cast<size_t>(columns * rows))
+	{
+		tile_workers.assign(columns * rows, -1);
+	}
+
+	// group the trackers by the tile which has the centre of their most recent rectangle
+	std::vector<int> tracker_tile(trackers.size(), -1);
+	std::map<int, size_t> group_sizes;
+	for (size_t idx = 0; idx < trackers.size(); idx ++)
+	{
+		const ObjectTracker & ot = trackers[idx];
+		if (ot.is_valid == false)
+		{
+			// it will never be queued again, so there's no tile to remember
+			tracker_tiles.erase(ot.name);
+			continue;
+		}
+
+		int tile = 0;
+		if (ot.rect.width > 0.0 and ot.rect.height > 0.0)
+		{
+			const int column	= std::clamp(static_cast<int>((ot.rect.x + ot.rect.width	/ 2.0) / tile_size), 0, columns	- 1);
+			const int row		= std::clamp(static_cast<int>((ot.rect.y + ot.rect.height	/ 2.0) / tile_size), 0, rows	- 1);
+			tile = row * columns + column;
+			tracker_tiles[ot.name] = tile;
+		}
+		else if (tracker_tiles.count(ot.name))
+		{
+			// a tracker which lost its object is still searching the same area
+			tile = tracker_tiles[ot.name];
+		}
+		tracker_tile[idx] = tile;
+		group_sizes[tile] ++;
+	}
+
+	// the largest groups are placed first, since they are the hardest to fit
+	std::vector<std::pair<size_t, int>> groups;
+	for (const auto & [tile, size] : group_sizes)
+	{
+		groups.push_back({size, tile});
+	}
+	std::sort(groups.begin(), groups.end(), std::greater<>());
+
+	// a tile stays on its worker unless that worker would get more than half again its fair share
+	const size_t fair_share	= (remaining_tasks + pool.size() - 1) / pool.size();
+	const size_t limit		= fair_share + fair_share / 2;
+	std::vector<size_t> load(pool.size(), 0);
+	for (const auto & [size, tile] : groups)
+	{
+		int & worker = tile_workers[tile];
+		if (worker < 0 or static_cast<size_t>(worker) >= load.size() or load[worker] + size > limit)
+		{
+			worker = std::min_element(load.begin(), load.end()) - load.begin();
+		}
+		load[worker] += size;
+	}
+
+	// submitted in priority order, so each worker still runs its most important trackers first
+	for (size_t idx = 0; idx < trackers.size(); idx ++)
+	{
+		if (tracker_tile[idx] >= 0)
+		{
+			pool.submit([this, idx] { run_tracker(idx); }, tile_workers[tracker_tile[idx]]);
+		}
+	}
+
+	return;
+}
+
+
+void TrackingSession::run_tracker(const size_t idx)
+{
+	try
+	{
+		ObjectTracker & ot = trackers[idx];
+		const cv::Size frame_size = (current.frame.empty() ? current.compact.size() : current.frame.size());
+		if (current_padding == 0)
+		{
+			cv::Mat mat = current.frame;
+			if (mat.empty() and is_tracker_due(ot, current.frame_index))
+			{
+				// the conversion is skipped entirely when the only trackers due on this frame work in greyscale
+				mat = (ot.needs_colour ? get_current_bgr() : current.compact.luma());
+			}
+			update_tracker(ot, mat, current.frame_index, fps_rounded, verbose);
+		}
+		else
+		{
+			const int padding = current_padding;
+			const cv::Mat padded = get_current_padded();
+			cv::Point offset(std::round(current_motion.x - ot.motion_origin.x), std::round(current_motion.y - ot.motion_origin.y));
+			if (ot.is_valid and (std::abs(offset.x) > padding or std::abs(offset.y) > padding))
+			{
+				if (ot.last_valid + 1 == current.frame_index and ot.rect.width > 0.0)
+				{
+					// the camera moved further than the padding, so start again from where the object should be now
+					const cv::Rect2d predicted = ot.rect + cv::Point2d(current_motion - previous_motion);
+					ot.tracker = create_tracker(get_tracker_profile(ot.name));
+					cv::Mat unshifted = padded(cv::Rect(cv::Point(padding, padding), frame_size));
+					ot.tracker->init(unshifted, predicted);
+					ot.rect				= predicted;
+					ot.motion_origin	= current_motion;
+					offset				= cv::Point(0, 0);
+					if (verbose)
+					{
+						std::cout << "-> re-initialized tracker for \"" << ot.name << "\" after the camera moved more than " << padding << " pixels" << std::endl;
+					}
+				}
+				else
+				{
+					// the object was already lost, so let the tracker look as far as it can
+					offset.x = std::clamp(offset.x, -padding, padding);
+					offset.y = std::clamp(offset.y, -padding, padding);
+				}
+			}
+
+			cv::Mat shifted = padded(cv::Rect(cv::Point(padding + offset.x, padding + offset.y), frame_size));
+			update_tracker(ot, shifted, current.frame_index, fps_rounded, verbose, offset);
+		}
+
+		if ((crop.size() != video_size or excluded.empty() == false) and ot.is_valid and ot.last_valid == current.frame_index)
+		{
+			// an object which leaves the ROI or moves into an excluded area won't be found again in the blanked pixels
+			const cv::Point centre(ot.rect.x + ot.rect.width / 2.0, ot.rect.y + ot.rect.height / 2.0);
+			if (cv::Rect(cv::Point(0, 0), desired_size).contains(centre) == false or (excluded.empty() == false and excluded.at<uint8_t>(centre.y, centre.x) != 0))
+			{
+				if (verbose)
+				{
+					std::cout << "-> removing tracker for \"" << ot.name << "\" since the object left the ROI at frame #" << current.frame_index << std::endl;
+				}
+				ot.is_valid = false;
+			}
+		}
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		error = std::current_exception();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	remaining_tasks --;
+	if (remaining_tasks == 0)
+	{
+		// we're the last tracker to finish this frame
+		for (const auto & ot : trackers)
+		{
+			current.tracks.push_back({ot.name, ot.colour, ot.rect, ot.is_valid and ot.last_valid == current.frame_index, ot.is_valid});
+		}
+		output.push_back(std::move(current));
+		busy = false;
+		start_next_frame();
+		frame_finished.notify_all();
+		resume_waiting_coroutine();
+	}
+
+	return;
+}
+
+
+cv::Mat TrackingSession::get_current_bgr()
+{
+	// the other trackers which need colour wait for the first one to convert it, rather than each converting their own
+	std::lock_guard<std::mutex> lock(bgr_mutex);
+	if (current_bgr.empty())
+	{
+		current_bgr = current.compact.bgr();
+	}
+
+	return current_bgr;
+}
+
+
+cv::Mat TrackingSession::get_current_padded()
+{
+	std::lock_guard<std::mutex> lock(bgr_mutex);
+	if (current_padded.empty())
+	{
+		// the BGR copy is only needed long enough to add the border
+		const cv::Mat bgr = current.compact.bgr();
+		cv::copyMakeBorder(bgr, current_padded, current_padding, current_padding, current_padding, current_padding, cv::BORDER_REPLICATE);
+	}
+
+	return current_padded;
+}
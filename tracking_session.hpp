@@ -0,0 +1,290 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "compact_frame.hpp"
+#include "duplicate_frames.hpp"
+#include "frame_source.hpp"
+#include "global_motion.hpp"
+#include "region.hpp"
+#include "tracker.hpp"
+#include "worker_pool.hpp"
+#include <coroutine>
+#include <exception>
+#include <set>
+
+
+/// Where one object was found in one frame.
+struct TrackResult
+{
+	std::string	name;
+	cv::Scalar	colour;
+	cv::Rect2d	rect;	///< (-1, -1, -1, -1) if the object was not found in this frame
+	bool		found;	///< @p true if the tracker reported positive results for this frame
+	bool		valid;	///< @p false once the tracker has been retired
+};
+
+typedef std::vector<TrackResult> VTrackResults;
+
+
+/// Everything we know about one frame once all of the trackers have been updated.
+struct FrameResults
+{
+	size_t			frame_index;	///< zero-based index of the frame within the session
+	cv::Mat			frame;			///< the frame which was given to @ref TrackingSession::push_frame(); empty if @ref compact is used
+	CompactFrame	compact;		///< the same frame in YUV 4:2:0 when the session uses compact frames
+	VTrackResults	tracks;			///< one entry per tracker
+	bool			duplicate = false;	///< @p true if the trackers weren't updated because the frame repeats the previous one
+};
+
+
+/// How the trackers of a session are spread across the worker pool.
+enum class TrackerAssignment
+{
+	any,	///< the trackers go round-robin to the worker queues, so a tracker may run on a different core every frame
+	tiles	///< trackers are grouped by the tile of the frame they are in, and each tile stays on the same worker
+};
+
+TrackerAssignment to_tracker_assignment(const std::string & name);
+std::string to_string(const TrackerAssignment assignment);
+
+
+/** Everything needed to track the objects in one video:  the input, sizing and timing information, and the set of
+ * trackers.  Frames are pushed in, the trackers are updated on a @ref WorkerPool which can be shared with other sessions,
+ * and the results are pulled out in the same order the frames were pushed.  Many sessions can run concurrently in the
+ * same process.
+ */
+class TrackingSession
+{
+	public:
+
+		TrackingSession(WorkerPool & worker_pool);
+
+		/// Waits for any frames which are still being tracked.
+		~TrackingSession();
+
+		TrackingSession(const TrackingSession &) = delete;
+		TrackingSession & operator=(const TrackingSession &) = delete;
+
+		/** Open the video, get the timing information we need, and display a few statistics.  Frames larger than
+		 * @p maximum_size (or @ref default_maximum_size if it is empty) will be resized to fit.
+		 */
+		void open(const std::string & filename, const cv::Size & maximum_size = cv::Size(), const bool verbose = true);
+
+		/** For callers which push their own frames instead of calling @ref open().  The first call sets @ref video_size,
+		 * @ref crop and @ref desired_size to @p size, so frames are tracked as they are given.  Later calls throw
+		 * @p std::invalid_argument if @p size is different.
+		 */
+		void use_frame_size(const cv::Size & size);
+
+		/** Read the next frame from the input, crop it to the ROI, resize it to @ref desired_size, and blank the excluded
+		 * areas.  Returns @p false at the end of the video.
+		 */
+		bool read_frame(cv::Mat & mat);
+
+		/** Skip the next frame of the input:  it is grabbed but never retrieved, converted, cropped or resized.  Returns
+		 * @p false at the end of the video.
+		 */
+		bool skip_frame();
+
+		/// Read the first frame, then rewind the input so the next call to @ref read_frame() starts at the beginning.
+		cv::Mat get_first_frame();
+
+		/** Add a tracker.  It is initialized immediately using @p mat (which must be at @ref desired_size), and @p mat
+		 * must be the next frame given to @ref push_frame():  frames which were pushed earlier but haven't started
+		 * tracking yet are never given to it.  A tracker with the same name is replaced when that frame starts.  Safe to
+		 * call while frames are in flight.
+		 */
+		void add_tracker(const std::string & tracker_name, const cv::Scalar & colour, const cv::Rect2d & rect, cv::Mat & mat);
+
+		/// Same as above, but using X, Y, W, H coordinates normalized to the original video (before it is cropped).
+		void add_tracker(const std::string & tracker_name, const cv::Scalar & colour, const double x, const double y, const double w, const double h, cv::Mat & mat);
+
+		/// Stop tracking an object.  This takes effect starting with the next frame.  Safe to call while frames are in flight.
+		void remove_tracker(const std::string & tracker_name);
+
+		/** Queue a frame (already at @ref desired_size) for tracking and return immediately.  The trackers run on the
+		 * worker pool.  The frame must not be modified until its results have been pulled.  Returns the index the
+		 * frame will have in its @ref FrameResults.  A frame which repeats the previous one is recognized here, and its
+		 * results are copied from the previous frame without updating the trackers.
+		 */
+		size_t push_frame(const cv::Mat & mat);
+
+		/** Get the results for the oldest frame which has finished tracking.  If @p wait is @p true this blocks until
+		 * the results are ready.  Returns @p false if there are no frames in flight, or if @p wait is @p false and the
+		 * oldest frame isn't ready yet.  Any exception thrown by a tracker is re-thrown here.
+		 */
+		bool pull_results(FrameResults & results, const bool wait = true);
+
+		/// Number of frames which were pushed but have not yet been pulled.
+		size_t frames_in_flight() const;
+
+		/// Number of frames checked for duplicates so far (none unless the check is enabled), and how many of them were duplicates. @{
+		size_t frames_checked() const { return duplicates.frames; }
+		size_t duplicate_frames() const { return duplicates.duplicates; }
+		/// @}
+
+		/// The worker pool which updates the trackers.
+		WorkerPool & get_pool() const { return pool; }
+
+		/// Tell the session no more frames will be pushed, so @ref next_results() knows when the video has ended.
+		void end_input();
+
+		/** Same as @ref pull_results() but for coroutines:  @p co_await @p next_results(results) suspends the calling
+		 * coroutine without blocking a thread until the oldest frame has finished tracking, and continues it on the
+		 * worker pool.  Returns @p false once @ref end_input() has been called and every frame has been pulled.  Only
+		 * one coroutine at a time may wait for results.
+		 */
+		auto next_results(FrameResults & results)
+		{
+			struct Awaiter
+			{
+				TrackingSession & session;
+				FrameResults & results;
+
+				bool await_ready() const noexcept { return false; }
+				bool await_suspend(std::coroutine_handle<> handle) { return session.wait_for_results(handle); }
+				bool await_resume() { return session.pull_results(results, false); }
+			};
+
+			return Awaiter{*this, results};
+		}
+
+		/** Get the most recent position of every valid tracker, including the ones which were just added.  If a frame is
+		 * being tracked this waits for it to finish.
+		 */
+		VTrackResults get_tracks() const;
+
+		/// Convert a rectangle in pixels of the original video to pixels of the cropped and resized frames.
+		cv::Rect2d video_to_frame(const cv::Rect2d & rect) const;
+
+		/// Convert a rectangle in pixels of the cropped and resized frames back to pixels of the original video.
+		cv::Rect2d frame_to_video(const cv::Rect2d & rect) const;
+
+		/// Size which frames are resized to fit when @ref open() isn't given one.  Set from the configuration file.
+		static cv::Size default_maximum_size;
+
+		/// ROI and exclusion areas used by sessions opened after it is set.  Set from the configuration file.
+		static RegionOfInterest default_region;
+
+		/// Tolerance used by new sessions to recognize duplicate frames; negative (the default) disables it.  See @ref DuplicateFrameDetector.
+		static int default_duplicate_tolerance;
+
+		/** Whether new sessions estimate the camera motion of each frame and give each tracker the frame shifted back by
+		 * the motion since the tracker was initialized, so panning doesn't move the objects out of the trackers' search
+		 * areas.  See @ref GlobalMotionEstimator.
+		 */
+		static bool default_motion_compensation;
+
+		/** Whether new sessions keep queued frames in YUV 4:2:0 (see @ref CompactFrame) rather than BGR.  Frames are
+		 * converted when they are pushed, converted back to BGR at most once while they are tracked and only if a
+		 * tracker which needs colour is due to be updated, and @ref FrameResults::frame is left empty.
+		 */
+		static bool default_compact_frames;
+
+		/** How new sessions assign their trackers to the workers.  With @p tiles, the frame is divided into squares of
+		 * @ref default_tile_size pixels and the trackers in the same square are queued on the same worker, since their
+		 * search areas overlap and the pixels they share are then already in that core's cache.  A tile keeps its
+		 * worker from one frame to the next unless that worker would get more than half again its share of the
+		 * trackers, and idle workers still steal from busy ones.
+		 */
+		static TrackerAssignment default_tracker_assignment;
+
+		/// Width and height in pixels (of the resized frames) of the tiles used by @ref TrackerAssignment::tiles.
+		static int default_tile_size;
+
+		std::string name;			///< filename or other name used to identify this session
+		std::string window_title;
+		FrameSource cap;
+		cv::Size video_size;		///< size of the original video's frames
+		cv::Rect crop;				///< part of each original frame which is kept; the whole frame unless there is an ROI
+		cv::Size desired_size;
+		size_t fps_rounded;
+		size_t total_frames;
+		std::chrono::high_resolution_clock::duration frame_duration;
+		bool verbose;				///< log when trackers lose their object
+
+	private:
+
+		/// Start tracking the next queued frame.  Must be called with the mutex held and no frame in progress.
+		void start_next_frame();
+
+		/// Called on a worker thread for each valid tracker.
+		void run_tracker(const size_t idx);
+
+		/// Queue a task on the pool for each valid tracker, according to @ref tracker_assignment.  Must be called with the mutex held.
+		void submit_trackers();
+
+		/// BGR copy of the compact frame being tracked, converted by the first tracker which asks for it.
+		cv::Mat get_current_bgr();
+
+		/** Padded copy of the frame being tracked when compensating for camera motion.  Compact frames are only padded
+		 * here, by the first tracker which asks for it, so a queued frame never has both a compact and a padded copy.
+		 */
+		cv::Mat get_current_padded();
+
+		/// Remember @p handle to be resumed when results are ready.  Returns @p false if they're ready now.
+		bool wait_for_results(std::coroutine_handle<> handle);
+
+		/// If a coroutine is waiting and results are ready, resume it on the pool.  Must be called with the mutex held.
+		void resume_waiting_coroutine();
+
+		WorkerPool & pool;
+
+		cv::Mat excluded;	///< at @ref desired_size, 255 where the frame is blanked; empty if nothing is blanked
+
+		mutable std::mutex mutex;
+		mutable std::condition_variable frame_finished;
+
+		/// All trackers used while the video is being processed (people, ball, etc).
+		VObjectTrackers trackers;
+
+		/// Trackers which were added or removed while a frame was in flight; applied before the next frame starts. @{
+		VObjectTrackers pending_trackers;
+		std::set<std::string> pending_removals;
+		/// @}
+
+		struct QueuedFrame
+		{
+			cv::Mat		mat;
+			bool		duplicate;
+			cv::Point2d	motion;		///< total camera motion since the first frame
+			cv::Mat		padded;		///< @ref mat with a border so it can be shifted by the camera motion; empty if not compensating or compacting
+			int			padding;	///< width of the border around @ref padded, or zero if not compensating
+			CompactFrame	compact;	///< used instead of @ref mat when compacting frames
+		};
+
+		/// Only used by the thread which pushes the frames. @{
+		DuplicateFrameDetector duplicates;
+		GlobalMotionEstimator motion_estimator;
+		cv::Point2d total_motion;
+		/// @}
+
+		bool compensate_motion;				///< set from @ref default_motion_compensation
+		bool compact_frames;				///< set from @ref default_compact_frames
+		TrackerAssignment tracker_assignment;	///< set from @ref default_tracker_assignment
+		int tile_size;						///< set from @ref default_tile_size
+		std::vector<int> tile_workers;		///< worker each tile is queued on, or -1 if none has been chosen yet
+		std::map<std::string, int> tracker_tiles;	///< last tile of each tracker, used while it has lost its object
+		std::mutex bgr_mutex;				///< held while @ref current_bgr or @ref current_padded is converted
+		cv::Mat current_bgr;				///< see @ref get_current_bgr(); empty until a tracker needs it
+		cv::Point2d previous_motion;		///< total camera motion of the frame before @ref current
+		cv::Point2d current_motion;			///< total camera motion of @ref current
+		cv::Mat current_padded;				///< see @ref get_current_padded(); empty if not compensating
+		int current_padding;				///< border around @ref current_padded, or zero if not compensating
+		std::deque<QueuedFrame> input;		///< frames waiting for the trackers
+		std::deque<FrameResults> output;	///< frames which are done, waiting to be pulled
+		size_t next_frame_index;			///< index which will be given to the next frame which starts tracking
+		bool busy;							///< @p true while the trackers are working on @ref current
+		FrameResults current;				///< the frame the trackers are working on
+		size_t remaining_tasks;				///< trackers which haven't finished with @ref current
+		std::exception_ptr error;
+		bool input_ended;					///< set by @ref end_input()
+		bool frame_size_fixed;				///< set by @ref use_frame_size()
+		std::coroutine_handle<> waiting;	///< coroutine suspended in @ref next_results()
+};
+
+
+/// Called with the first frame of a session so the trackers can be created.
+typedef std::function<void(TrackingSession & session, cv::Mat & mat)> TrackerInitializer;
@@ -0,0 +1,233 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+
+#include "worker_pool.hpp"
+#include "affinity.hpp"
+#include "numa.hpp"
+
+
+/// Set on each worker thread so tasks submitted from within a task stay on the same worker. @{
+static thread_local const WorkerPool * current_pool	= nullptr;
+static thread_local size_t current_worker			= 0;
+/// @}
+
+
+WorkerPool::WorkerPool(const size_t number_of_threads, const int node) :
+	next_queue(0),
+	pending(0),
+	steals(0),
+	tasks_run(0),
+	busy_nanoseconds(0),
+	numa_node(node),
+	start_time(std::chrono::high_resolution_clock::now()),
+	stopping(false)
+{
+	size_t n = number_of_threads;
+	if (n == 0)
+	{
+		n = (numa_node >= 0 ? get_numa_nodes().at(numa_node).cpus.size() : std::max(1u, std::thread::hardware_concurrency()));
+	}
+	for (size_t idx = 0; idx < n; idx ++)
+	{
+		queues.emplace_back(new TaskQueue);
+	}
+	for (auto counters : {&llc, &dtlb})
+	{
+		counters->loads	.resize(n);
+		counters->misses.resize(n);
+	}
+	for (size_t idx = 0; idx < n; idx ++)
+	{
+		threads.emplace_back(&WorkerPool::run, this, idx);
+	}
+
+	return;
+}
+
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	trigger.notify_all();
+
+	for (auto & t : threads)
+	{
+		t.join();
+	}
+
+	return;
+}
+
+
+double WorkerPool::get_utilisation() const
+{
+	const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+	return (elapsed > 0.0 ? busy_nanoseconds / (elapsed * threads.size()) : 0.0);
+}
+
+
+void WorkerPool::get_llc_counts(uint64_t & loads, uint64_t & misses) const
+{
+	read_counters(llc, loads, misses);
+
+	return;
+}
+
+
+void WorkerPool::get_dtlb_counts(uint64_t & loads, uint64_t & misses) const
+{
+	read_counters(dtlb, loads, misses);
+
+	return;
+}
+
+
+void WorkerPool::read_counters(const CacheCounters & counters, uint64_t & loads, uint64_t & misses) const
+{
+	loads	= 0;
+	misses	= 0;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t idx = 0; idx < counters.loads.size(); idx ++)
+	{
+		if (counters.loads[idx] and counters.misses[idx])
+		{
+			loads	+= counters.loads[idx]	->read();
+			misses	+= counters.misses[idx]	->read();
+		}
+	}
+
+	return;
+}
+
+
+void WorkerPool::open_counters(CacheCounters & counters, const size_t idx, const PerfCounter::Event loads, const PerfCounter::Event misses)
+{
+	// per-thread counters, so only the work of the tasks is counted and not the decoder's
+	std::unique_ptr<PerfCounter> load_counter	(new PerfCounter(loads	, 0, false));
+	std::unique_ptr<PerfCounter> miss_counter	(new PerfCounter(misses	, 0, false));
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (load_counter->is_valid() and miss_counter->is_valid())
+	{
+		counters.loads[idx]		= std::move(load_counter);
+		counters.misses[idx]	= std::move(miss_counter);
+	}
+
+	return;
+}
+
+
+void WorkerPool::submit(std::function<void()> task)
+{
+	push(current_pool == this ? current_worker : next_queue ++ % queues.size(), std::move(task));
+
+	return;
+}
+
+
+void WorkerPool::submit(std::function<void()> task, const size_t worker)
+{
+	push(worker % queues.size(), std::move(task));
+
+	return;
+}
+
+
+void WorkerPool::push(const size_t idx, std::function<void()> task)
+{
+	{
+		// the count is changed with the mutex held so a worker which is about to go to sleep cannot miss it
+		std::lock_guard<std::mutex> lock(mutex);
+		pending ++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queues[idx]->mutex);
+		queues[idx]->tasks.push_back(std::move(task));
+	}
+
+	// a sleeping worker other than the one we want may wake up and steal it, which is how the load stays balanced
+	trigger.notify_one();
+
+	return;
+}
+
+
+bool WorkerPool::get_task(const size_t idx, std::function<void()> & task)
+{
+	for (size_t offset = 0; offset < queues.size(); offset ++)
+	{
+		TaskQueue & queue = *queues[(idx + offset) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+		{
+			continue;
+		}
+
+		if (offset == 0)
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		else
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			steals ++;
+		}
+		pending --;
+
+		return true;
+	}
+
+	return false;
+}
+
+
+void WorkerPool::run(const size_t idx)
+{
+	current_pool	= this;
+	current_worker	= idx;
+
+	if (pin_thread_to_stage(PipelineStage::workers))
+	{
+		// explicit worker CPUs take precedence over the NUMA node
+	}
+	else if (numa_node >= 0)
+	{
+		// the arena chunks and tracker models this thread allocates are then node-local too
+		pin_thread_to_numa_node(numa_node);
+	}
+	register_thread("worker " + std::to_string(idx));
+
+	open_counters(llc	, idx, PerfCounter::Event::llc_loads	, PerfCounter::Event::llc_load_misses	);
+	open_counters(dtlb	, idx, PerfCounter::Event::dtlb_loads	, PerfCounter::Event::dtlb_load_misses	);
+
+	while (true)
+	{
+		std::function<void()> task;
+		if (get_task(idx, task))
+		{
+			const auto task_start = std::chrono::high_resolution_clock::now();
+			task();
+			busy_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - task_start).count();
+			tasks_run ++;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		trigger.wait(lock, [&] { return stopping or pending > 0; });
+		if (stopping and pending == 0)
+		{
+			break;
+		}
+	}
+
+	return;
+}
@@ -0,0 +1,120 @@
+// CSRT object tracking example (C) 2021 Stephane Charette <stephanecharette@gmail.com>
+// MIT license applies.  See "license.txt" for details.
+
+#pragma once
+
+#include "perf_counters.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/** A fixed set of worker threads shared by every @ref TrackingSession in the process, so several videos can be tracked
+ * at once without each one bringing its own threads.  Each worker has its own task queue.  Tasks submitted from a
+ * worker go to that worker's queue, other tasks are spread across the queues, and a worker which runs out of tasks
+ * steals from the other queues.
+ */
+class WorkerPool
+{
+	public:
+
+		/** Start @p number_of_threads workers.  Zero means one per CPU core.  If @p numa_node is not negative, the
+		 * workers are pinned to that node (see numa.hpp) and zero means one per CPU core of that node.
+		 */
+		explicit WorkerPool(const size_t number_of_threads = 0, const int numa_node = -1);
+
+		/// Stops the workers once all the tasks which have already been submitted have run.
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool &) = delete;
+		WorkerPool & operator=(const WorkerPool &) = delete;
+
+		/// Queue a task.  Tasks must not throw; catch and store any exception within the task itself.
+		void submit(std::function<void()> task);
+
+		/** Queue a task on worker @p worker (modulo the number of workers), so related tasks submitted to the same
+		 * worker frame after frame keep finding their data in that core's cache.  Another worker still steals the task
+		 * if it runs out of work first.
+		 */
+		void submit(std::function<void()> task, const size_t worker);
+
+		size_t size() const { return threads.size(); }
+
+		/// Number of tasks which were run by a worker other than the one they were queued on.
+		size_t get_steal_count() const { return steals; }
+
+		/// The NUMA node the workers are pinned to, or @p -1.
+		int get_numa_node() const { return numa_node; }
+
+		/// Number of tasks which have been run.
+		size_t get_task_count() const { return tasks_run; }
+
+		/// Fraction of the time the workers have spent running tasks since the pool was created.
+		double get_utilisation() const;
+
+		/** Last level cache loads and load misses of all the workers since they started, from the hardware counters.
+		 * Both are zero if the counters are not available.
+		 */
+		void get_llc_counts(uint64_t & loads, uint64_t & misses) const;
+
+		/// Same as @ref get_llc_counts() but for the data TLB.
+		void get_dtlb_counts(uint64_t & loads, uint64_t & misses) const;
+
+	private:
+
+		/// One queue per worker.  The owner takes tasks from the front, thieves take them from the back.
+		struct TaskQueue
+		{
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		/// Get the next task for worker @p idx, either from its own queue or stolen from another one.
+		bool get_task(const size_t idx, std::function<void()> & task);
+
+		void run(const size_t idx);
+
+		/// Add @p task to the queue of worker @p idx.
+		void push(const size_t idx, std::function<void()> task);
+
+		std::vector<std::unique_ptr<TaskQueue>> queues;
+		std::atomic<size_t> next_queue;	///< round-robin index for tasks submitted from outside the pool
+		std::atomic<size_t> pending;	///< tasks which have been queued but not yet taken
+		std::atomic<size_t> steals;
+		std::atomic<size_t> tasks_run;
+		std::atomic<uint64_t> busy_nanoseconds;
+
+		/// Loads and load misses of one kind of cache, counted by each worker for itself.
+		struct CacheCounters
+		{
+			std::vector<std::unique_ptr<PerfCounter>> loads;
+			std::vector<std::unique_ptr<PerfCounter>> misses;
+		};
+
+		/// Open the counters for worker @p idx on the calling thread.
+		void open_counters(CacheCounters & counters, const size_t idx, const PerfCounter::Event loads, const PerfCounter::Event misses);
+
+		/// Sum the counters of every worker.
+		void read_counters(const CacheCounters & counters, uint64_t & loads, uint64_t & misses) const;
+
+		/// Only accessed with @ref mutex held. @{
+		CacheCounters llc;
+		CacheCounters dtlb;
+		/// @}
+		const int numa_node;
+		const std::chrono::high_resolution_clock::time_point start_time;
+
+		/// Only used to put idle workers to sleep. @{
+		mutable std::mutex mutex;
+		std::condition_variable trigger;
+		bool stopping;
+		/// @}
+
+		std::vector<std::thread> threads;
+};